@@ -0,0 +1,187 @@
+// pretty poly scene benchmark
+//
+// renders each canonical scene (see scenes.h) at every antialias level and
+// reports throughput and frame time percentiles as json on stdout. the
+// coordinate type and tile size are compile time options so they are swept by
+// building separate variants (see CMakeLists.txt)
+//
+// usage: pp_bench [frames] [scene]
+//
+// the pp_bench_stats variant also writes a heatmap of the time spent rendering
+// each 8x8 pixel cell in the last frame of each run to heatmap_<scene>_<aa>.pgm
+// and the pp_bench_trace variant writes a chrome trace of the last frame of
+// each run to trace_<scene>_<aa>.json in the current directory
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+
+#include "scenes.h"
+
+#define STR(x) #x
+#define XSTR(x) STR(x)
+
+uint32_t canvas[1024 * 1024];
+uint32_t pen;
+
+uint64_t tiles, pixels, edges;
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// a plain scalar blend so the timings include a realistic consumer of the
+// tile data without being dominated by it
+void blend_tile(const pp_tile_t *t) {
+  uint32_t sr = pen & 0xff, sg = (pen >> 8) & 0xff, sb = (pen >> 16) & 0xff;
+  for(int32_t y = 0; y < t->h; y++) {
+    uint8_t *src = t->data + y * t->stride;
+    uint32_t *dst = canvas + (t->y + y) * 1024 + t->x;
+    for(int32_t x = 0; x < t->w; x++) {
+      uint32_t a = src[x];
+      if(!a) continue;
+      uint32_t d = dst[x], ia = 255 - a;
+      uint32_t r = (sr * a + (d & 0xff) * ia) / 255;
+      uint32_t g = (sg * a + ((d >> 8) & 0xff) * ia) / 255;
+      uint32_t b = (sb * a + ((d >> 16) & 0xff) * ia) / 255;
+      dst[x] = r | (g << 8) | (b << 16) | 0xff000000;
+    }
+  }
+  tiles++;
+  pixels += t->w * t->h;
+}
+
+void bench_draw(pp_poly_t *poly, uint32_t colour) {
+  for(pp_path_t *path = poly->paths; path; path = path->next) {
+    edges += path->count;
+  }
+  pen = colour;
+  pp_render(poly);
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+  return ua < ub ? -1 : ua > ub;
+}
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20;
+  const char *filter = argc > 2 ? argv[2] : NULL;
+  if(frames < 1) frames = 1;
+
+  const struct {const char *name; pp_antialias_t aa;} levels[] = {
+    {"none", PP_AA_NONE}, {"x4", PP_AA_X4}, {"x8", PP_AA_X8}, {"x16", PP_AA_X16}
+  };
+
+  uint64_t *times = malloc(sizeof(uint64_t) * frames);
+
+  scene_draw = bench_draw;
+  pp_tile_callback(blend_tile);
+
+  printf("{\n");
+  printf("  \"variant\": {\"coord_type\": \"%s\", \"tile_buffer_size\": %d},\n",
+    XSTR(PP_COORD_TYPE), PP_TILE_BUFFER_SIZE);
+  printf("  \"results\": [");
+
+  bool first = true;
+  for(int s = 0; s < scene_count; s++) {
+    scene_t *scene = &scenes[s];
+    if(filter && strcmp(filter, scene->name) != 0) continue;
+
+    scene->init();
+#ifdef PP_STATS
+    pp_heatmap_t *heatmap = pp_heatmap_new(scene->w, scene->h, 8);
+#endif
+    pp_clip(0, 0, scene->w, scene->h);
+
+    for(size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+      pp_antialias(levels[l].aa);
+
+      // one untimed frame to warm up caches and the allocator
+      memset(canvas, 0, sizeof(canvas));
+      scene->frame(0);
+
+      tiles = pixels = edges = 0;
+      PP_STAT(pp_stats_reset());
+      uint64_t total = 0;
+      for(int f = 0; f < frames; f++) {
+        memset(canvas, 0, sizeof(canvas));
+#ifdef PP_TRACE
+        // record a timeline of the last frame
+        if(f == frames - 1) { pp_trace_reset(); pp_trace(true); }
+#endif
+#ifdef PP_STATS
+        // record the cost heatmap of the last frame
+        if(f == frames - 1) { pp_heatmap_clear(heatmap); pp_heatmap(heatmap); }
+#endif
+        uint64_t start = now_ns();
+        scene->frame(f);
+        times[f] = now_ns() - start;
+        total += times[f];
+      }
+
+#ifdef PP_STATS
+      pp_heatmap(NULL);
+      char heatmap_name[64];
+      snprintf(heatmap_name, sizeof(heatmap_name), "heatmap_%s_%s.pgm", scene->name, levels[l].name);
+      FILE *heatmap_file = fopen(heatmap_name, "wb");
+      if(heatmap_file) { pp_heatmap_write_pgm(heatmap, PP_HEATMAP_TIME, heatmap_file); fclose(heatmap_file); }
+#endif
+
+#ifdef PP_TRACE
+      pp_trace(false);
+      char filename[64];
+      snprintf(filename, sizeof(filename), "trace_%s_%s.json", scene->name, levels[l].name);
+      FILE *trace = fopen(filename, "w");
+      if(trace) { pp_trace_dump(trace); fclose(trace); }
+#endif
+
+      qsort(times, frames, sizeof(uint64_t), compare_u64);
+      double seconds = total / 1e9;
+      double p50 = times[(frames - 1) / 2] / 1e6;
+      double p99 = times[(frames * 99 - 1) / 100] / 1e6;
+
+      printf("%s\n    {\"scene\": \"%s\", \"aa\": \"%s\", \"frames\": %d, ",
+        first ? "" : ",", scene->name, levels[l].name, frames);
+      printf("\"edges_per_frame\": %llu, \"tiles_per_frame\": %llu, \"pixels_per_frame\": %llu, ",
+        (unsigned long long)(edges / frames), (unsigned long long)(tiles / frames), (unsigned long long)(pixels / frames));
+      printf("\"mpixels_per_s\": %.3f, \"tiles_per_s\": %.1f, \"edges_per_s\": %.1f, ",
+        pixels / seconds / 1e6, tiles / seconds, edges / seconds);
+      printf("\"p50_ms\": %.3f, \"p99_ms\": %.3f, \"mean_ms\": %.3f",
+        p50, p99, total / 1e6 / frames);
+#ifdef PP_STATS
+      // per frame averages of the renderer's own counters
+      const pp_stats_t *st = pp_stats();
+      printf(", \"stats\": {\"tiles_visited\": %u, \"tiles_empty\": %u, \"tiles_rendered\": %u, \"tiles_split\": %u, ",
+        st->tiles_visited / frames, st->tiles_empty / frames, st->tiles_rendered / frames, st->tiles_split / frames);
+      printf("\"nodes\": %u, \"nodes_dropped\": %u, \"max_nodes_per_row\": %u, \"rows\": %u, \"pixels_resolved\": %u, ",
+        st->nodes / frames, st->nodes_dropped / frames, st->max_nodes_per_row, st->rows / frames, st->pixels_resolved / frames);
+      printf("\"bounds_ms\": %.3f, \"build_ms\": %.3f, \"span_ms\": %.3f, \"resolve_ms\": %.3f, \"callback_ms\": %.3f}",
+        st->time_bounds / 1e6 / frames, st->time_build / 1e6 / frames, st->time_span / 1e6 / frames,
+        st->time_resolve / 1e6 / frames, st->time_callback / 1e6 / frames);
+#endif
+      printf("}");
+      fflush(stdout);
+      first = false;
+    }
+
+    scene->deinit();
+#ifdef PP_STATS
+    pp_heatmap_free(heatmap);
+#endif
+  }
+
+  printf("\n  ]\n}\n");
+
+  free(times);
+  return 0;
+}
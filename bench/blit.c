@@ -0,0 +1,414 @@
+// pretty poly blitter benchmark
+//
+// records the tiles of one frame of each canonical scene (see scenes.h) and
+// then times compositing them into a 32bpp framebuffer with:
+//
+//   example - the per pixel blend() from the examples' helpers.h
+//   scalar  - the portable pretty-poly-blit.h kernel
+//   simd    - the pretty-poly-blit.h kernel for this build (SSE2, or AVX2 in
+//             the pp_bench_blit_avx2 variant)
+//
+// for both a solid colour and a per-pixel paint. every kernel's framebuffer is
+// checked against the example's, any difference is reported and the program
+// exits with a non-zero status
+//
+// the packed formats (RGB565, RGB332, and a 16 colour palette) are timed
+// against converting each pixel to 32-bit, blending it with blend(), and
+// converting back. they blend with less precision so the largest difference
+// in any channel (in the format's own units) is reported instead
+//
+// every target of ppb_tile() is also checked with each packed tile format
+// (PP_TILE_4BPP, PP_TILE_1BPP, and PP_TILE_1BPP_DITHER): its output must match
+// expanding the tiles to 8bpp first
+//
+// usage: pp_bench_blit [milliseconds per measurement]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#define PPB_IMPLEMENTATION
+#include "pretty-poly-blit.h"
+
+#include "scenes.h"
+#include "../examples/c/helpers.h"
+
+#define FB_W 1024
+#define FB_H 1024
+
+uint32_t fb_example[FB_W * FB_H], fb_test[FB_W * FB_H];
+uint16_t fb16_convert[FB_W * FB_H], fb16_packed[FB_W * FB_H];
+uint8_t fb8_convert[FB_W * FB_H], fb8_packed[FB_W * FB_H];
+
+uint64_t min_ns = 200000000; // time each measurement for at least this long
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// -- recorded tiles ------------------------------------------------------------
+
+typedef struct {
+  pp_tile_t tile;
+  uint32_t colour;
+} record_t;
+
+record_t *records;
+int record_count, record_size;
+uint64_t record_pixels;
+uint32_t pen;
+
+void record_tile(const pp_tile_t *t) {
+  if(record_count == record_size) {
+    record_size = record_size ? record_size * 2 : 1024;
+    records = realloc(records, sizeof(record_t) * record_size);
+  }
+  // keep a tightly packed copy of the coverage
+  record_t *r = &records[record_count++];
+  r->tile = *t;
+  r->tile.stride = t->w;
+  r->tile.data = malloc(t->w * t->h);
+  for(int32_t y = 0; y < t->h; y++) {
+    memcpy(r->tile.data + y * t->w, t->data + y * t->stride, t->w);
+  }
+  r->colour = pen;
+  record_pixels += t->w * t->h;
+}
+
+void record_draw(pp_poly_t *poly, uint32_t colour) {
+  pen = colour;
+  pp_render(poly);
+}
+
+void free_records() {
+  for(int i = 0; i < record_count; i++) free(records[i].tile.data);
+  record_count = 0;
+  record_pixels = 0;
+}
+
+// -- paint ---------------------------------------------------------------------
+
+// a diagonal gradient with varying alpha, `data` is the base colour
+void gradient(int32_t x, int32_t y, int32_t w, uint32_t *colours, void *data) {
+  uint32_t c = *(uint32_t *)data;
+  for(int32_t i = 0; i < w; i++) {
+    uint32_t v = (x + i + y) & 0xff;
+    colours[i] = (c & 0x0000ffff) | (v << 16) | ((128 + (v >> 1)) << 24);
+  }
+}
+
+// -- blitters ------------------------------------------------------------------
+
+enum {SOLID, PAINT, RGB565, RGB332, PALETTE};
+const char *mode_names[] = {"solid", "paint", "rgb565", "rgb332", "palette"};
+
+typedef void (*blit_t)(const record_t *r, void *fb, int mode);
+
+// the examples' tile callback
+void blit_example(const record_t *r, void *fb, int mode) {
+  const pp_tile_t *t = &r->tile;
+  bool paint = mode == PAINT;
+  colour *buffer = (colour *)fb;
+  uint32_t row[FB_W];
+  for(int32_t y = 0; y < t->h; y++) {
+    if(paint) gradient(t->x, t->y + y, t->w, row, (void *)&r->colour);
+    for(int32_t x = 0; x < t->w; x++) {
+      colour c = {.c = paint ? row[x] : r->colour};
+      c.a = alpha(c.a, pp_tile_get(t, t->x + x, t->y + y));
+      colour *d = &buffer[(t->y + y) * FB_W + t->x + x];
+      *d = blend(*d, c);
+    }
+  }
+}
+
+void blit_scalar(const record_t *r, void *fb, int mode) {
+  const pp_tile_t *t = &r->tile;
+  bool paint = mode == PAINT;
+  uint32_t row[FB_W];
+  for(int32_t y = 0; y < t->h; y++) {
+    uint32_t *dst = (uint32_t *)fb + (t->y + y) * FB_W + t->x;
+    if(paint) gradient(t->x, t->y + y, t->w, row, (void *)&r->colour);
+    _ppb_row_8888_scalar(dst, t->data + y * t->stride, t->w, paint ? row : NULL, r->colour);
+  }
+}
+
+void blit_simd(const record_t *r, void *fb, int mode) {
+  if(mode == PAINT) {
+    ppb_paint_8888(&r->tile, fb, FB_W, gradient, (void *)&r->colour);
+  } else {
+    ppb_blit_rgba8888(&r->tile, fb, FB_W, r->colour);
+  }
+}
+
+// -- packed formats ------------------------------------------------------------
+
+// a 16 colour palette, the palette run draws each tile in the entry nearest
+// to its colour
+uint32_t palette[16];
+ppb_ramp_t ramps[16];
+
+uint32_t from_565(uint16_t c) {
+  uint32_t r = (c >> 11) & 0x1f, g = (c >> 5) & 0x3f, b = c & 0x1f;
+  return ((r << 3) | (r >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((b << 3) | (b >> 2)) << 16) | 0xff000000;
+}
+
+uint16_t to_565(uint32_t c) {
+  return (uint16_t)((((c & 0xff) >> 3) << 11) | ((((c >> 8) & 0xff) >> 2) << 5) | (((c >> 16) & 0xff) >> 3));
+}
+
+uint32_t from_332(uint8_t c) {
+  uint32_t r = c >> 5, g = (c >> 2) & 7, b = c & 3;
+  return (r * 255 / 7) | ((g * 255 / 7) << 8) | ((b * 255 / 3) << 16) | 0xff000000;
+}
+
+uint8_t to_332(uint32_t c) {
+  return (uint8_t)((c & 0xe0) | (((c >> 8) & 0xff) >> 3 & 0x1c) | (((c >> 16) & 0xff) >> 6));
+}
+
+// convert every pixel to 32-bit, blend with the examples' blend(), and convert
+// it back to the framebuffer's format
+void blit_convert(const record_t *r, void *fb, int mode) {
+  const pp_tile_t *t = &r->tile;
+  int p = _ppb_nearest(palette, 16, r->colour);
+  for(int32_t y = 0; y < t->h; y++) {
+    for(int32_t x = 0; x < t->w; x++) {
+      uint8_t a = t->data[y * t->stride + x];
+      if(!a) continue;
+      int32_t i = (t->y + y) * FB_W + t->x + x;
+      colour c = {.c = mode == PALETTE ? palette[p] : r->colour};
+      c.a = alpha(c.a, a);
+      colour d;
+      switch(mode) {
+        case RGB565: d.c = from_565(((uint16_t *)fb)[i]); break;
+        case RGB332: d.c = from_332(((uint8_t *)fb)[i]); break;
+        default:     d.c = palette[((uint8_t *)fb)[i]]; break;
+      }
+      d = blend(d, c);
+      switch(mode) {
+        case RGB565: ((uint16_t *)fb)[i] = to_565(d.c); break;
+        case RGB332: ((uint8_t *)fb)[i] = to_332(d.c); break;
+        default:     ((uint8_t *)fb)[i] = _ppb_nearest(palette, 16, d.c); break;
+      }
+    }
+  }
+}
+
+void blit_packed(const record_t *r, void *fb, int mode) {
+  switch(mode) {
+    case RGB565: ppb_blit_rgb565(&r->tile, fb, FB_W, r->colour); break;
+    case RGB332: ppb_blit_rgb332(&r->tile, fb, FB_W, r->colour); break;
+    default: ppb_blit_palette(&r->tile, fb, FB_W, &ramps[_ppb_nearest(palette, 16, r->colour)]); break;
+  }
+}
+
+// largest difference in any channel between two packed framebuffers
+int max_error(int mode, void *a, void *b) {
+  int worst = 0;
+  for(int i = 0; i < FB_W * FB_H; i++) {
+    uint32_t ca, cb;
+    int shifts[3], bits[3];
+    if(mode == RGB565) {
+      ca = ((uint16_t *)a)[i]; cb = ((uint16_t *)b)[i];
+      shifts[0] = 11; bits[0] = 5; shifts[1] = 5; bits[1] = 6; shifts[2] = 0; bits[2] = 5;
+    } else if(mode == RGB332) {
+      ca = ((uint8_t *)a)[i]; cb = ((uint8_t *)b)[i];
+      shifts[0] = 5; bits[0] = 3; shifts[1] = 2; bits[1] = 3; shifts[2] = 0; bits[2] = 2;
+    } else {
+      // palette entries compared in 8-bit channels
+      ca = palette[((uint8_t *)a)[i]]; cb = palette[((uint8_t *)b)[i]];
+      shifts[0] = 0; bits[0] = 8; shifts[1] = 8; bits[1] = 8; shifts[2] = 16; bits[2] = 8;
+    }
+    for(int c = 0; c < 3; c++) {
+      int va = (ca >> shifts[c]) & ((1 << bits[c]) - 1);
+      int vb = (cb >> shifts[c]) & ((1 << bits[c]) - 1);
+      worst = _pp_max(worst, abs(va - vb));
+    }
+  }
+  return worst;
+}
+
+size_t fb_size(int mode) {
+  return (mode == RGB565 ? 2 : mode >= RGB332 ? 1 : 4) * FB_W * FB_H;
+}
+
+void blit_all(blit_t blit, void *fb, int mode) {
+  for(int i = 0; i < record_count; i++) blit(&records[i], fb, mode);
+}
+
+double measure(blit_t blit, void *fb, int mode) {
+  uint64_t iterations = 0, start = now_ns(), elapsed;
+  do {
+    memset(fb, 0, fb_size(mode));
+    blit_all(blit, fb, mode);
+    iterations++;
+  } while((elapsed = now_ns() - start) < min_ns);
+  // remove the cost of clearing the framebuffer
+  start = now_ns();
+  for(uint64_t i = 0; i < iterations; i++) {
+    memset(fb, 0, fb_size(mode));
+    __asm__ volatile("" ::: "memory");
+  }
+  elapsed -= _pp_min(elapsed, now_ns() - start);
+
+  // leave one frame in the framebuffer for the output checks
+  memset(fb, 0, fb_size(mode));
+  blit_all(blit, fb, mode);
+  return (double)elapsed / iterations / record_pixels;
+}
+
+// -- packed tiles --------------------------------------------------------------
+//
+// each tile is drawn through ppb_tile() as it is into fb_test and expanded to
+// 8bpp by hand into fb_example
+
+ppb_target_t packed_target;
+uint32_t packed_colour;
+
+void packed_tile(const pp_tile_t *t) {
+  uint8_t *data = malloc(t->w * t->h);
+  for(int32_t y = 0; y < t->h; y++) {
+    for(int32_t x = 0; x < t->w; x++) data[y * t->w + x] = pp_tile_get(t, t->x + x, t->y + y);
+  }
+  pp_tile_t expanded = *t;
+  expanded.data = data;
+  expanded.stride = t->w;
+  expanded.format = PP_TILE_8BPP;
+
+  ppb_target_t target = packed_target;
+  target.fb = fb_example;
+  ppb_target(&target);
+  ppb_tile(&expanded);
+
+  target.fb = fb_test;
+  ppb_target(&target);
+  ppb_tile(t);
+  free(data);
+}
+
+void packed_draw(pp_poly_t *poly, uint32_t colour) {
+  packed_colour = colour;
+  packed_target.colour = colour;
+  packed_target.ramp = &ramps[_ppb_nearest(palette, 16, colour)];
+  pp_render(poly);
+}
+
+int check_packed_tiles() {
+  const pp_tile_format_t formats[] = {PP_TILE_4BPP, PP_TILE_1BPP, PP_TILE_1BPP_DITHER};
+  const char *format_names[] = {"4bpp", "1bpp", "1bpp dither"};
+  const struct {const char *name; ppb_format_t format; bool paint;} targets[] = {
+    {"rgba8888", PPB_RGBA8888, false}, {"bgra8888", PPB_BGRA8888, false}, {"paint", PPB_RGBA8888, true},
+    {"under", PPB_RGBA8888_UNDER, false}, {"rgb565", PPB_RGB565, false}, {"rgb332", PPB_RGB332, false},
+    {"palette", PPB_PALETTE, false}, {"1bpp", PPB_1BPP, false}
+  };
+
+  int failures = 0;
+  scene_draw = packed_draw;
+  pp_tile_callback(packed_tile);
+  for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+    pp_tile_format(formats[f]);
+    for(size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); t++) {
+      packed_target = (ppb_target_t){
+        .format = targets[t].format, .stride = targets[t].format == PPB_1BPP ? FB_W / 8 : FB_W,
+        .paint = targets[t].paint ? gradient : NULL, .paint_data = &packed_colour
+      };
+      memset(fb_example, 0, sizeof(fb_example));
+      memset(fb_test, 0, sizeof(fb_test));
+      scene_logo_init();
+      pp_clip(0, 0, FB_W, FB_H);
+      scene_logo_frame(0);
+      scene_logo_deinit();
+      if(memcmp(fb_test, fb_example, sizeof(fb_test)) != 0) {
+        fprintf(stderr, "%s tiles to %s: output differs from expanded tiles\n", format_names[f], targets[t].name);
+        failures++;
+      }
+    }
+  }
+  pp_tile_format(PP_TILE_8BPP);
+  return failures;
+}
+
+int main(int argc, char **argv) {
+  if(argc > 1) min_ns = (uint64_t)atoi(argv[1]) * 1000000;
+
+  const struct {const char *name; blit_t blit;} blitters[] = {
+    {"example", blit_example}, {"scalar", blit_scalar}, {"simd", blit_simd}
+  };
+
+#if defined(PPB_AVX2)
+  const char *simd = "avx2";
+#elif defined(PPB_SSE2)
+  const char *simd = "sse2";
+#else
+  const char *simd = "none";
+#endif
+
+  for(int i = 0; i < 16; i++) {
+    palette[i] = i ? scene_hsv((i - 1) / 14.0f, 1.0f) : 0xff000000;
+  }
+  palette[15] = 0xffffffff;
+  for(int i = 0; i < 16; i++) ppb_ramp(&ramps[i], palette, 16, palette[i]);
+
+  pp_antialias(PP_AA_X4);
+  int failures = check_packed_tiles();
+
+  scene_draw = record_draw;
+  pp_tile_callback(record_tile);
+
+  printf("{\n");
+  printf("  \"variant\": {\"simd\": \"%s\"},\n", simd);
+  printf("  \"results\": [");
+
+  bool first = true;
+  for(int s = 0; s < scene_count; s++) {
+    scene_t *scene = &scenes[s];
+    scene->init();
+    pp_clip(0, 0, _pp_min(scene->w, FB_W), _pp_min(scene->h, FB_H));
+    scene->frame(0);
+    scene->deinit();
+
+    for(int mode = SOLID; mode <= PAINT; mode++) {
+      double ns[3];
+      for(int b = 0; b < 3; b++) {
+        ns[b] = measure(blitters[b].blit, b ? fb_test : fb_example, mode);
+        if(b && memcmp(fb_test, fb_example, sizeof(fb_test)) != 0) {
+          fprintf(stderr, "%s %s %s: output differs from example\n",
+            scene->name, mode_names[mode], blitters[b].name);
+          failures++;
+        }
+      }
+
+      printf("%s\n    {\"scene\": \"%s\", \"mode\": \"%s\", \"tiles\": %d, \"pixels\": %llu, ",
+        first ? "" : ",", scene->name, mode_names[mode], record_count, (unsigned long long)record_pixels);
+      printf("\"example_ns_per_pixel\": %.3f, \"scalar_ns_per_pixel\": %.3f, \"simd_ns_per_pixel\": %.3f, \"speedup\": %.2f}",
+        ns[0], ns[1], ns[2], ns[0] / ns[2]);
+      fflush(stdout);
+      first = false;
+    }
+
+    for(int mode = RGB565; mode <= PALETTE; mode++) {
+      void *convert = mode == RGB565 ? (void *)fb16_convert : (void *)fb8_convert;
+      void *packed = mode == RGB565 ? (void *)fb16_packed : (void *)fb8_packed;
+      double convert_ns = measure(blit_convert, convert, mode);
+      double packed_ns = measure(blit_packed, packed, mode);
+
+      printf(",\n    {\"scene\": \"%s\", \"mode\": \"%s\", \"tiles\": %d, \"pixels\": %llu, ",
+        scene->name, mode_names[mode], record_count, (unsigned long long)record_pixels);
+      printf("\"convert_ns_per_pixel\": %.3f, \"packed_ns_per_pixel\": %.3f, \"speedup\": %.2f, \"max_error\": %d}",
+        convert_ns, packed_ns, convert_ns / packed_ns, max_error(mode, convert, packed));
+      fflush(stdout);
+    }
+
+    free_records();
+  }
+
+  printf("\n  ]\n}\n");
+  return failures ? 1 : 0;
+}
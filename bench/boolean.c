@@ -0,0 +1,193 @@
+// pretty poly boolean operations benchmark
+//
+// builds composite shapes out of overlapping primitives:
+//
+//   cross  - four thick lines crossing at the centre of an icon
+//   gear   - a disc with 24 teeth and a hole, (disc + teeth) - hole
+//   cloud  - 64 overlapping circles
+//
+// and reduces each to its outline with pp_poly_boolean() once, as an app
+// would at load time. reports how long that takes, the edge count before and
+// after, and the median time and pixels blended to draw the parts one by one
+// (every overlap blended again) against drawing the outline, as json on
+// stdout
+//
+// usage: pp_bench_boolean [frames]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#define PPB_IMPLEMENTATION
+#include "pretty-poly-blit.h"
+
+#define FB_W 512
+#define FB_H 512
+
+uint32_t fb[FB_W * FB_H];
+
+uint64_t pixels_blended;
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void count_tile(const pp_tile_t *tile) {
+  pixels_blended += tile->w * tile->h;
+  ppb_blit_rgba8888(tile, fb, FB_W, 0xffe0a040);
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+  return ua < ub ? -1 : ua > ub;
+}
+
+double median_ms(uint64_t *times, int frames) {
+  qsort(times, frames, sizeof(uint64_t), compare_u64);
+  return times[(frames - 1) / 2] / 1e6;
+}
+
+int edge_count(pp_poly_t *poly) {
+  int edges = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) edges += path->count;
+  return edges;
+}
+
+int contour_count(pp_poly_t *poly) {
+  int contours = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) contours++;
+  return contours;
+}
+
+// -- shapes ----------------------------------------------------------------------
+//
+// each is a list of parts combined in order, the first with PP_UNION onto
+// nothing and the rest with their own operation
+
+typedef struct {
+  pp_poly_t *poly;
+  pp_boolean_t op;
+} part_t;
+
+part_t parts[128];
+int part_count;
+
+void add(pp_poly_t *poly, pp_boolean_t op) {
+  parts[part_count++] = (part_t){poly, op};
+}
+
+void build_cross() {
+  add(ppp_line((ppp_line_def){96, 256, 416, 256, 40}), PP_UNION);
+  add(ppp_line((ppp_line_def){256, 96, 256, 416, 40}), PP_UNION);
+  add(ppp_line((ppp_line_def){143, 143, 369, 369, 40}), PP_UNION);
+  add(ppp_line((ppp_line_def){369, 143, 143, 369, 40}), PP_UNION);
+}
+
+void build_gear() {
+  add(ppp_circle((ppp_circle_def){256, 256, 180, 0}), PP_UNION);
+  for(int i = 0; i < 24; i++) {
+    float a = i * 2 * M_PI / 24, c = cosf(a), s = sinf(a);
+    pp_poly_t *tooth = pp_poly_new();
+    pp_path_t *path = pp_poly_add_path(tooth);
+    float corners[4][2] = {{160, -14}, {230, -10}, {230, 10}, {160, 14}};
+    for(int j = 0; j < 4; j++) {
+      pp_path_add_point(path, (pp_point_t){256 + corners[j][0] * c - corners[j][1] * s, 256 + corners[j][0] * s + corners[j][1] * c});
+    }
+    add(tooth, PP_UNION);
+  }
+  add(ppp_circle((ppp_circle_def){256, 256, 60, 0}), PP_DIFFERENCE);
+}
+
+void build_cloud() {
+  uint32_t seed = 1;
+  for(int i = 0; i < 64; i++) {
+    seed = seed * 1664525u + 1013904223u; float x = 96 + (seed >> 8) % 320;
+    seed = seed * 1664525u + 1013904223u; float y = 160 + (seed >> 8) % 192;
+    seed = seed * 1664525u + 1013904223u; float r = 24 + (seed >> 8) % 48;
+    add(ppp_circle((ppp_circle_def){x, y, r, 0}), PP_UNION);
+  }
+}
+
+// -- main ------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20;
+  if(frames < 1) frames = 1;
+
+  uint64_t *times = malloc(sizeof(uint64_t) * frames);
+  const struct {const char *name; void (*build)();} shapes[] = {
+    {"cross", build_cross}, {"gear", build_gear}, {"cloud", build_cloud}
+  };
+
+  pp_clip(0, 0, FB_W, FB_H);
+  pp_antialias(PP_AA_X4);
+  pp_tile_callback(count_tile);
+
+  printf("{\n");
+  printf("  \"variant\": {\"width\": %d, \"height\": %d},\n", FB_W, FB_H);
+  printf("  \"results\": [");
+
+  for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+    part_count = 0;
+    shapes[s].build();
+
+    int edges_before = 0;
+    for(int i = 0; i < part_count; i++) edges_before += edge_count(parts[i].poly);
+
+    uint64_t start = now_ns();
+    pp_poly_t *outline = pp_poly_new();
+    for(int i = 0; i < part_count; i++) {
+      pp_poly_t *next = pp_poly_boolean(outline, parts[i].poly, parts[i].op);
+      pp_poly_free(outline);
+      outline = next;
+    }
+    double combine_ms = (now_ns() - start) / 1e6;
+
+    // the parts, as they would be drawn without combining them. parts taken
+    // away can't be drawn so are skipped
+    uint64_t parts_pixels = 0;
+    for(int f = 0; f < frames; f++) {
+      pixels_blended = 0;
+      uint64_t start = now_ns();
+      for(int i = 0; i < part_count; i++) {
+        if(parts[i].op == PP_UNION) pp_render(parts[i].poly);
+      }
+      times[f] = now_ns() - start;
+      parts_pixels = pixels_blended;
+    }
+    double parts_ms = median_ms(times, frames);
+
+    uint64_t outline_pixels = 0;
+    for(int f = 0; f < frames; f++) {
+      pixels_blended = 0;
+      uint64_t start = now_ns();
+      pp_render(outline);
+      times[f] = now_ns() - start;
+      outline_pixels = pixels_blended;
+    }
+    double outline_ms = median_ms(times, frames);
+
+    printf("%s\n    {\"shape\": \"%s\", \"parts\": %d, \"edges_before\": %d, \"edges_after\": %d, \"contours\": %d, ",
+      s ? "," : "", shapes[s].name, part_count, edges_before, edge_count(outline), contour_count(outline));
+    printf("\"combine_ms\": %.3f, \"parts_ms\": %.3f, \"outline_ms\": %.3f, ", combine_ms, parts_ms, outline_ms);
+    printf("\"parts_pixels\": %llu, \"outline_pixels\": %llu}",
+      (unsigned long long)parts_pixels, (unsigned long long)outline_pixels);
+    fflush(stdout);
+
+    pp_poly_free(outline);
+    for(int i = 0; i < part_count; i++) pp_poly_free(parts[i].poly);
+  }
+
+  printf("\n  ]\n}\n");
+
+  free(times);
+  return 0;
+}
@@ -0,0 +1,193 @@
+// pretty poly full canvas benchmark
+//
+// renders large polygons into 1080p and 4K coverage canvases at every
+// antialias level, once with pp_render() and a tile callback that copies each
+// tile into the canvas and once with pp_render_canvas(), and reports the
+// frame times of both as json on stdout. the two canvases are compared after
+// every run, any difference is reported and the program exits with a
+// non-zero status
+//
+// usage: pp_bench_canvas [frames]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+uint8_t *tiled, *direct;
+int32_t canvas_w;
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void copy_tile(const pp_tile_t *t) {
+  for(int32_t y = 0; y < t->h; y++) {
+    memcpy(tiled + (t->y + y) * canvas_w + t->x, t->data + y * t->stride, t->w);
+  }
+}
+
+// -- shapes ------------------------------------------------------------------
+//
+// each shape fills most of a w x h canvas
+
+// a 128 pointed star
+pp_poly_t *shape_star(int32_t w, int32_t h) {
+  pp_poly_t *poly = pp_poly_new();
+  pp_path_t *path = pp_poly_add_path(poly);
+  float r = 0.48f * (w < h ? w : h);
+  for(int i = 0; i < 256; i++) {
+    float a = i * (float)M_PI / 128.0f, s = i & 1 ? 0.6f : 1.0f;
+    pp_path_add_point(path, (pp_point_t){w / 2 + cosf(a) * r * s, h / 2 + sinf(a) * r * s});
+  }
+  return poly;
+}
+
+// a ring, two 1024 point circles
+pp_poly_t *shape_ring(int32_t w, int32_t h) {
+  pp_poly_t *poly = pp_poly_new();
+  float r = 0.48f * (w < h ? w : h);
+  for(int c = 0; c < 2; c++) {
+    pp_path_t *path = pp_poly_add_path(poly);
+    for(int i = 0; i < 1024; i++) {
+      float a = (c ? -i : i) * 2.0f * (float)M_PI / 1024.0f, s = c ? 0.7f : 1.0f;
+      pp_path_add_point(path, (pp_point_t){w / 2 + cosf(a) * r * s, h / 2 + sinf(a) * r * s});
+    }
+  }
+  return poly;
+}
+
+// the full width of the canvas with a wavy top edge, very long spans
+pp_poly_t *shape_wave(int32_t w, int32_t h) {
+  pp_poly_t *poly = pp_poly_new();
+  pp_path_t *path = pp_poly_add_path(poly);
+  for(int i = 0; i <= 2048; i++) {
+    float x = (float)w * i / 2048;
+    pp_path_add_point(path, (pp_point_t){x, h * (0.3f + 0.2f * sinf(x * 0.01f))});
+  }
+  pp_path_add_point(path, (pp_point_t){0, (float)h});
+  return poly;
+}
+
+// 64 overlapping circles, many crossings on every scanline
+pp_poly_t *shape_blobs(int32_t w, int32_t h) {
+  pp_poly_t *poly = pp_poly_new();
+  uint32_t seed = 1;
+  for(int c = 0; c < 64; c++) {
+    pp_path_t *path = pp_poly_add_path(poly);
+    seed = seed * 1664525u + 1013904223u; float cx = (seed >> 8) / 16777216.0f * w;
+    seed = seed * 1664525u + 1013904223u; float cy = (seed >> 8) / 16777216.0f * h;
+    float r = h * 0.15f;
+    for(int i = 0; i < 64; i++) {
+      float a = i * 2.0f * (float)M_PI / 64.0f;
+      pp_path_add_point(path, (pp_point_t){cx + cosf(a) * r, cy + sinf(a) * r});
+    }
+  }
+  return poly;
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+  return ua < ub ? -1 : ua > ub;
+}
+
+// median time of `frames` renders
+double median_ms(uint64_t *times, int frames) {
+  qsort(times, frames, sizeof(uint64_t), compare_u64);
+  return times[(frames - 1) / 2] / 1e6;
+}
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 10;
+  if(frames < 1) frames = 1;
+
+  const struct {const char *name; int32_t w, h;} canvases[] = {
+    {"1080p", 1920, 1080}, {"4k", 3840, 2160}
+  };
+
+  const struct {const char *name; pp_poly_t *(*create)(int32_t w, int32_t h);} shapes[] = {
+    {"star", shape_star}, {"ring", shape_ring}, {"wave", shape_wave}, {"blobs", shape_blobs}
+  };
+
+  const struct {const char *name; pp_antialias_t aa;} levels[] = {
+    {"none", PP_AA_NONE}, {"x4", PP_AA_X4}, {"x8", PP_AA_X8}, {"x16", PP_AA_X16}
+  };
+
+  uint64_t *times = malloc(sizeof(uint64_t) * frames);
+  pp_tile_callback(copy_tile);
+
+  printf("{\n");
+  printf("  \"variant\": {\"tile_buffer_size\": %d, \"node_buffer_height\": %d},\n",
+    PP_TILE_BUFFER_SIZE, PP_NODE_BUFFER_HEIGHT);
+  printf("  \"results\": [");
+
+  int failures = 0;
+  bool first = true;
+  for(size_t c = 0; c < sizeof(canvases) / sizeof(canvases[0]); c++) {
+    int32_t w = canvases[c].w, h = canvases[c].h;
+    canvas_w = w;
+    tiled = calloc(w * h, 1);
+    direct = calloc(w * h, 1);
+    pp_clip(0, 0, w, h);
+
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+      pp_poly_t *poly = shapes[s].create(w, h);
+
+      for(size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        pp_antialias(levels[l].aa);
+
+        // the tiled render only writes covered tiles so clear it every frame,
+        // the canvas render overwrites the polygon's bounds itself
+        for(int f = 0; f < frames; f++) {
+          uint64_t start = now_ns();
+          memset(tiled, 0, w * h);
+          pp_render(poly);
+          times[f] = now_ns() - start;
+        }
+        double tiled_ms = median_ms(times, frames);
+
+        // pixels outside of the polygon's bounds are left alone
+        memset(direct, 0, w * h);
+        for(int f = 0; f < frames; f++) {
+          uint64_t start = now_ns();
+          pp_render_canvas(poly, direct, w, h);
+          times[f] = now_ns() - start;
+        }
+        double direct_ms = median_ms(times, frames);
+
+        if(memcmp(tiled, direct, w * h) != 0) {
+          fprintf(stderr, "%s %s %s: canvas differs from tiled render\n",
+            canvases[c].name, shapes[s].name, levels[l].name);
+          failures++;
+        }
+
+        printf("%s\n    {\"canvas\": \"%s\", \"shape\": \"%s\", \"aa\": \"%s\", ",
+          first ? "" : ",", canvases[c].name, shapes[s].name, levels[l].name);
+        printf("\"tiled_ms\": %.3f, \"canvas_ms\": %.3f, \"speedup\": %.2f}",
+          tiled_ms, direct_ms, tiled_ms / direct_ms);
+        fflush(stdout);
+        first = false;
+      }
+
+      pp_poly_free(poly);
+    }
+
+    free(tiled);
+    free(direct);
+  }
+
+  printf("\n  ]\n}\n");
+
+  free(times);
+  return failures ? 1 : 0;
+}
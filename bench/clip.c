@@ -0,0 +1,162 @@
+// pretty poly clip path benchmark
+//
+// scrolls a list of 200 rows (a card, an avatar, and two lines of "text"
+// each) through a rounded panel clipped with pp_clip_path() three ways:
+//
+//   rect     - clipped to the panel's bounding rectangle only, the cost
+//              without a clip path
+//   uncached - pp_clip_path() set again before every draw, so every tile of
+//              every draw rasterises its own clip mask
+//   cached   - pp_clip_path() set once per frame, draws sharing a tile share
+//              its mask
+//
+// and reports the median frame time and the clip masks rasterised and reused
+// per frame as json on stdout. the cached and uncached framebuffers are
+// compared after every run, any difference is reported and the program exits
+// with a non-zero status
+//
+// usage: pp_bench_clip [frames]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_STATS
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#define PPB_IMPLEMENTATION
+#include "pretty-poly-blit.h"
+
+#define FB_W 800
+#define FB_H 600
+#define ROWS 200
+#define ROW_H 56
+
+uint32_t fb_rect[FB_W * FB_H], fb_uncached[FB_W * FB_H], fb_cached[FB_W * FB_H];
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+  return ua < ub ? -1 : ua > ub;
+}
+
+double median_ms(uint64_t *times, int frames) {
+  qsort(times, frames, sizeof(uint64_t), compare_u64);
+  return times[(frames - 1) / 2] / 1e6;
+}
+
+// -- list ----------------------------------------------------------------------
+
+typedef struct {
+  pp_poly_t *poly;
+  uint32_t colour;
+} draw_t;
+
+draw_t draws[ROWS * 4];
+int draw_count;
+
+void add(pp_poly_t *poly, uint32_t colour) {
+  draws[draw_count++] = (draw_t){poly, colour};
+}
+
+// rows are built at the top of the list and scrolled with the transform
+void build_list() {
+  uint32_t seed = 1;
+  for(int i = 0; i < ROWS; i++) {
+    float y = i * ROW_H;
+    seed = seed * 1664525u + 1013904223u;
+    add(ppp_rect((ppp_rect_def){8, y + 4, 584, ROW_H - 8, 0, 6, 6, 6, 6}), 0xff302418);
+    add(ppp_circle((ppp_circle_def){36, y + ROW_H / 2, 18, 0}), 0xff000000 | (seed & 0xffffff));
+    add(ppp_rect((ppp_rect_def){64, y + 14, 160 + (seed >> 24), 10, 0, 3, 3, 3, 3}), 0xe0ffffff);
+    add(ppp_rect((ppp_rect_def){64, y + 32, 80 + (seed >> 25), 8, 0, 3, 3, 3, 3}), 0x80ffffff);
+  }
+}
+
+pp_rect_t panel = {100, 50, 600, 500};
+pp_poly_t *panel_path;
+
+// draw the rows visible at `scroll`, `mode` is 0 (rect), 1 (uncached), or 2
+// (cached)
+void draw_frame(uint32_t *fb, float scroll, int mode) {
+  for(int i = 0; i < FB_W * FB_H; i++) fb[i] = 0xff101010;
+
+  pp_clip(panel.x, panel.y, panel.w, panel.h);
+  if(mode == 2) pp_clip_path(panel_path);
+
+  pp_mat3_t m = pp_mat3_identity();
+  pp_mat3_translate(&m, panel.x, panel.y - scroll);
+  pp_transform(&m);
+
+  int first = (int)(scroll / ROW_H), last = (int)((scroll + panel.h) / ROW_H);
+  for(int i = first * 4; i < (last + 1) * 4 && i < draw_count; i++) {
+    if(mode == 1) pp_clip_path(panel_path);
+    ppb_target(&(ppb_target_t){.format = PPB_RGBA8888, .fb = fb, .stride = FB_W, .colour = draws[i].colour});
+    pp_render(draws[i].poly);
+  }
+
+  pp_transform(NULL);
+  pp_clip_path(NULL);
+  pp_clip(0, 0, FB_W, FB_H);
+}
+
+// -- main ------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20;
+  if(frames < 1) frames = 1;
+
+  uint64_t *times = malloc(sizeof(uint64_t) * frames);
+  uint32_t *fbs[] = {fb_rect, fb_uncached, fb_cached};
+  const char *names[] = {"rect", "uncached", "cached"};
+
+  pp_antialias(PP_AA_X4);
+  pp_tile_callback(ppb_tile);
+  build_list();
+  panel_path = ppp_rect((ppp_rect_def){panel.x, panel.y, panel.w, panel.h, 0, 32, 32, 32, 32});
+
+  printf("{\n");
+  printf("  \"variant\": {\"width\": %d, \"height\": %d, \"rows\": %d, \"cache_tiles\": %d},\n",
+    FB_W, FB_H, ROWS, PP_CLIP_CACHE_TILES);
+  printf("  \"results\": [");
+
+  // each frame scrolls a little further down the list
+  int failures = 0;
+  for(int mode = 0; mode < 3; mode++) {
+    pp_stats_t stats = {0};
+    for(int f = 0; f < frames; f++) {
+      float scroll = f * 37.5f;
+      pp_stats_reset();
+      uint64_t start = now_ns();
+      draw_frame(fbs[mode], scroll, mode);
+      times[f] = now_ns() - start;
+      stats = *pp_stats();
+    }
+    double ms = median_ms(times, frames);
+
+    printf("%s\n    {\"clip\": \"%s\", \"ms\": %.3f, \"draws\": %u, \"tiles\": %u, ",
+      mode ? "," : "", names[mode], ms, stats.polygons, stats.tiles_rendered);
+    printf("\"clip_masks\": %u, \"clip_mask_hits\": %u}", stats.clip_masks, stats.clip_mask_hits);
+    fflush(stdout);
+  }
+
+  if(memcmp(fb_uncached, fb_cached, sizeof(fb_cached)) != 0) {
+    fprintf(stderr, "cached clip masks differ from uncached\n");
+    failures++;
+  }
+
+  printf("\n  ]\n}\n");
+
+  for(int i = 0; i < draw_count; i++) pp_poly_free(draws[i].poly);
+  pp_poly_free(panel_path);
+  free(times);
+  return failures ? 1 : 0;
+}
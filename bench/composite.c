@@ -0,0 +1,215 @@
+// pretty poly deferred compositing benchmark
+//
+// builds a 200 element dashboard (panels, gauges, bar charts, and sparklines)
+// and renders it into a framebuffer three ways:
+//
+//   immediate - one pp_render() per element, each tile blended straight into
+//               the framebuffer with ppb_tile()
+//   replay    - the same with every element pps_prepare()d once up front, so
+//               each frame only fills spans and blends (pps_draw())
+//   composite - pps_composite(), every screen tile built up in a small colour
+//               buffer and written to the framebuffer once
+//
+// for RGBA8888 and RGB565 framebuffers at a range of screen tile sizes. the
+// median frame time and the number of framebuffer pixels each approach reads
+// and writes are reported as json on stdout. the framebuffers are compared
+// after every run, any difference is reported and the program exits with a
+// non-zero status
+//
+// usage: pp_bench_composite [frames]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#define PPB_IMPLEMENTATION
+#include "pretty-poly-blit.h"
+#define PPS_IMPLEMENTATION
+#include "pretty-poly-scene.h"
+
+#define FB_W 1280
+#define FB_H 720
+#define BACKGROUND 0xff201810
+
+uint32_t fb_immediate[FB_W * FB_H], fb_replay[FB_W * FB_H], fb_composite[FB_W * FB_H];
+uint32_t tile_colours[128 * 128];
+uint8_t tile_coverage[128 * 128];
+
+uint64_t fb_pixels; // framebuffer pixels blended by the immediate renderer
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void count_tile(const pp_tile_t *tile) {
+  fb_pixels += tile->w * tile->h;
+  ppb_tile(tile);
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+  return ua < ub ? -1 : ua > ub;
+}
+
+double median_ms(uint64_t *times, int frames) {
+  qsort(times, frames, sizeof(uint64_t), compare_u64);
+  return times[(frames - 1) / 2] / 1e6;
+}
+
+// -- dashboard -----------------------------------------------------------------
+
+pp_poly_t *polys[256];
+int poly_count;
+
+void add(pps_scene_t *scene, pp_poly_t *poly, uint32_t colour) {
+  polys[poly_count++] = poly;
+  pps_add(scene, poly, colour);
+}
+
+// twelve cards of sixteen elements each plus a header and a footer
+void build_dashboard(pps_scene_t *scene) {
+  uint32_t seed = 1;
+  add(scene, ppp_rect((ppp_rect_def){0, 0, FB_W, 48, 0, 0, 0, 0, 0}), 0xff402818);
+  add(scene, ppp_rect((ppp_rect_def){0, FB_H - 32, FB_W, 32, 0, 0, 0, 0, 0}), 0xff402818);
+
+  for(int card = 0; card < 12; card++) {
+    float x = 16 + (card % 4) * 316, y = 64 + (card / 4) * 208;
+
+    add(scene, ppp_rect((ppp_rect_def){x, y, 300, 192, 0, 12, 12, 12, 12}), 0xff302418);
+    add(scene, ppp_rect((ppp_rect_def){x, y, 300, 192, 2, 12, 12, 12, 12}), 0x80c08040);
+
+    // gauge: track, value, and needle hub
+    add(scene, ppp_arc((ppp_arc_def){x + 70, y + 100, 50, 10, -135, 135}), 0xff504030);
+    add(scene, ppp_arc((ppp_arc_def){x + 70, y + 100, 50, 10, -135, -135 + 27 * (card + 1) * 0.8f}), 0xff40c0f0);
+    add(scene, ppp_circle((ppp_circle_def){x + 70, y + 100, 8, 0}), 0xe0ffffff);
+
+    // bar chart
+    for(int bar = 0; bar < 6; bar++) {
+      seed = seed * 1664525u + 1013904223u;
+      float h = 20 + (seed >> 24) * 60 / 256.0f;
+      add(scene, ppp_rect((ppp_rect_def){x + 140 + bar * 24, y + 110 - h, 16, h, 0, 3, 3, 0, 0}), 0xc0f0a040);
+    }
+
+    // sparkline
+    float px = x + 140, py = y + 150;
+    for(int seg = 0; seg < 5; seg++) {
+      seed = seed * 1664525u + 1013904223u;
+      float nx = px + 28, ny = y + 135 + (seed >> 24) * 40 / 256.0f;
+      add(scene, ppp_line((ppp_line_def){px, py, nx, ny, 3}), 0xff60e060);
+      px = nx; py = ny;
+    }
+
+    add(scene, ppp_circle((ppp_circle_def){x + 280, y + 20, 6, 0}), card & 1 ? 0xff40f040 : 0xff4040f0);
+    add(scene, ppp_rect((ppp_rect_def){x + 16, y + 168, 268, 8, 0, 4, 4, 4, 4}), 0x60ffffff);
+  }
+}
+
+// -- main ------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20;
+  if(frames < 1) frames = 1;
+
+  const struct {const char *name; ppb_format_t format;} formats[] = {
+    {"rgba8888", PPB_RGBA8888}, {"rgb565", PPB_RGB565}
+  };
+  const int tile_sizes[] = {32, 64, 128};
+
+  uint64_t *times = malloc(sizeof(uint64_t) * frames);
+
+  pp_antialias(PP_AA_X4);
+  pp_clip(0, 0, FB_W, FB_H);
+  pps_scene_t *scene = pps_scene_new();
+  build_dashboard(scene);
+
+  printf("{\n");
+  printf("  \"variant\": {\"width\": %d, \"height\": %d, \"elements\": %d},\n", FB_W, FB_H, scene->count);
+  printf("  \"results\": [");
+
+  int failures = 0;
+  bool first = true;
+  for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+    ppb_format_t format = formats[f].format;
+    int bpp = format == PPB_RGB565 ? 2 : 4;
+
+    for(size_t s = 0; s < sizeof(tile_sizes) / sizeof(tile_sizes[0]); s++) {
+      int32_t ts = tile_sizes[s];
+      pp_tile_buffer(tile_coverage, ts, ts);
+
+      // immediate, clear the framebuffer and draw every element in turn
+      pp_tile_callback(count_tile);
+      for(int i = 0; i < frames; i++) {
+        uint64_t start = now_ns();
+        _pps_clear(format, fb_immediate, FB_W, FB_H, BACKGROUND);
+        fb_pixels = 0;
+        for(int j = 0; j < scene->count; j++) {
+          pps_item_t *item = &scene->items[j];
+          ppb_target(&(ppb_target_t){.format = format, .fb = fb_immediate, .stride = FB_W, .colour = item->colour});
+          pp_render(item->poly);
+        }
+        times[i] = now_ns() - start;
+      }
+      double immediate_ms = median_ms(times, frames);
+      uint64_t immediate_pixels = fb_pixels + FB_W * FB_H; // plus the clear
+
+      // replay, prepared for this tile size
+      uint64_t start = now_ns();
+      pps_prepare(scene);
+      double prepare_ms = (now_ns() - start) / 1e6;
+      size_t prepared_bytes = 0;
+      for(int j = 0; j < scene->count; j++) prepared_bytes += pp_prepared_save(scene->items[j].prepared, NULL);
+
+      for(int i = 0; i < frames; i++) {
+        uint64_t start = now_ns();
+        _pps_clear(format, fb_replay, FB_W, FB_H, BACKGROUND);
+        pps_draw(scene, &(ppb_target_t){.format = format, .fb = fb_replay, .stride = FB_W});
+        times[i] = now_ns() - start;
+      }
+      double replay_ms = median_ms(times, frames);
+
+      pps_framebuffer_t target = {
+        .format = format, .fb = fb_composite, .stride = FB_W, .w = FB_W, .h = FB_H,
+        .tile_w = ts, .tile_h = ts, .buffer = tile_colours, .background = BACKGROUND
+      };
+      for(int i = 0; i < frames; i++) {
+        uint64_t start = now_ns();
+        pps_composite(scene, &target);
+        times[i] = now_ns() - start;
+      }
+      double composite_ms = median_ms(times, frames);
+
+      if(memcmp(fb_immediate, fb_replay, FB_W * FB_H * bpp) != 0) {
+        fprintf(stderr, "%s %dx%d: replay differs from immediate render\n", formats[f].name, ts, ts);
+        failures++;
+      }
+      if(memcmp(fb_immediate, fb_composite, FB_W * FB_H * bpp) != 0) {
+        fprintf(stderr, "%s %dx%d: composite differs from immediate render\n", formats[f].name, ts, ts);
+        failures++;
+      }
+
+      printf("%s\n    {\"format\": \"%s\", \"tile\": %d, ", first ? "" : ",", formats[f].name, ts);
+      printf("\"immediate_ms\": %.3f, \"replay_ms\": %.3f, \"composite_ms\": %.3f, ",
+        immediate_ms, replay_ms, composite_ms);
+      printf("\"prepare_ms\": %.3f, \"prepared_bytes\": %zu, ", prepare_ms, prepared_bytes);
+      printf("\"immediate_fb_pixels\": %llu, \"composite_fb_pixels\": %d}",
+        (unsigned long long)immediate_pixels, FB_W * FB_H);
+      fflush(stdout);
+      first = false;
+    }
+  }
+
+  printf("\n  ]\n}\n");
+
+  pps_scene_free(scene);
+  for(int i = 0; i < poly_count; i++) pp_poly_free(polys[i]);
+  free(times);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,1036 @@
+// pretty poly differential fuzzer
+//
+// renders random polygons (random contours, transforms, clip rectangles, and
+// antialias levels) and checks the output of the renderer against a slow but
+// exact double precision reference rasteriser:
+//
+//   coverage - pixels with no edge nearby must match the reference exactly,
+//              pixels near an edge must be within `edge_tolerance` of the 
+//              exact coverage and the mean error over edge pixels within 
+//              `mean_tolerance`
+//   samples  - at X1 and X4, where one sample is a quarter of a pixel or
+//              more, every sample further than an edge can move from the
+//              reference's edges must match the reference's inside test
+//   seams    - output must be identical whatever tile shape is used to render
+//              it (tiles rasterise the same edges, so no seams can appear)
+//   clipping - output with a clip rectangle must be identical to the unclipped
+//              output cropped to that rectangle
+//   canvas   - pp_render_canvas() must produce exactly the tiled output
+//   region   - a pp_region_t built from random overlapping rects must cover
+//              exactly their union with disjoint rects, and output clipped to
+//              it (tiled and with pp_render_canvas()) must match the
+//              unclipped output inside it and leave everything outside of it
+//              untouched
+//   prepared - pp_render_prepared() of a pp_prepare()d polygon, saved and
+//              loaded again, must produce exactly the tiled output. a copy of
+//              the saved data with one byte corrupted must either fail to load
+//              or replay without writing outside of the tile buffer. moved
+//              to a random position beyond the 16-bit range it must replay
+//              exactly the tiles pp_render() draws there
+//   clip path - output with a random pp_clip_path() polygon must equal the 
+//              unclipped output scaled by that polygon's own coverage, with a
+//              random tile shape and again from the mask cache
+//   boolean   - pp_poly_boolean() of two random polygons must be inside at
+//              every random point where the operation on the even-odd
+//              insides of the two is (away from their edges, which move as
+//              points are snapped) and have no redundant points, as must
+//              pp_path_union() of their first paths
+//   simplify  - every contour of pp_poly_simplify() must be made of points of
+//              the contour it came from, in order, with each point dropped
+//              within the tolerance (in pixels, after the transform) of the
+//              segment replacing it. a contour dropped entirely must lie
+//              within the tolerance of a segment between two of its points
+//   lod       - each level of detail from pp_poly_lod_new() must have
+//              fewer edges and a larger error than the one before and be the
+//              polygon simplified to within that error. the level drawn must
+//              be within the threshold, with no threshold the output must be
+//              identical to drawing the polygon itself, and once points are
+//              added to the polygon the polygon must be drawn
+//   occlusion - output with a pp_occlusion_t mask (tiled and with
+//              pp_render_canvas()) must match the unclipped output with the
+//              hidden pixels cleared, drawn as opaque every fully covered
+//              pixel must be added to the mask (inside its row's span). no
+//              tile may be passed to the callback that lies entirely over
+//              hidden pixels
+//   packed    - output in a random packed tile format with a random tile
+//              shape must be the 8bpp output quantised (4bpp), thresholded
+//              (1bpp) or dithered by screen position, with each tile's
+//              stride the packed width of the tile buffer and no bits set
+//              past the end of a row. at X1 1bpp tiles must fit in a buffer
+//              of just the packed rows
+//
+// the tolerances are derived from the sampling grid of each antialias level:
+// vertices snap down to the sub-sample grid (up to one sub-sample), crossings
+// are the floor of the snapped edge's position (up to another) and coverage is
+// point sampled vertically once per sub-scanline. an edge can therefore move
+// by up to two sub-samples which at X4 can flip a whole pixel, so at X1 and X4
+// the per pixel coverage tolerance is no bound at all and `samples` checks
+// each sample against the displaced edge instead
+//
+// usage: pp_fuzz [iterations] [seed]
+//
+// on failure the seed and iteration are printed so the case can be replayed
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+
+#define SIZE 192          // canvas size
+#define REF_ROWS 64       // reference sub-rows per pixel
+#define MAX_POINTS 32     // total points, keeps every row within the node limit
+
+uint8_t canvas[SIZE][SIZE];
+uint8_t canvas_b[SIZE][SIZE];
+double reference[SIZE][SIZE];
+
+uint32_t seed;
+uint32_t fuzz_rand() {
+  seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+  return seed;
+}
+double fuzz_randf() { return (fuzz_rand() & 0xffffff) / (double)0x1000000; }
+int fuzz_range(int a, int b) { return a + (int)(fuzz_rand() % (uint32_t)(b - a + 1)); }
+
+// -- renderer under test -----------------------------------------------------
+
+uint8_t (*target)[SIZE] = canvas;
+int tile_aa_mismatch = 0;
+
+void copy_tile(const pp_tile_t *t) {
+  for(int32_t y = 0; y < t->h; y++) {
+    for(int32_t x = 0; x < t->w; x++) {
+      target[t->y + y][t->x + x] = t->data[x + y * t->stride];
+    }
+  }
+  if(_pp_antialias != PP_AA_AUTO && t->antialias != _pp_antialias) tile_aa_mismatch++;
+}
+
+void discard_tile(const pp_tile_t *t) {
+}
+
+// copies tiles drawn at `tile_offset` on screen into the target, counting
+// tiles that land outside of it
+pp_point_t tile_offset;
+int offset_tiles_outside = 0;
+void copy_offset_tile(const pp_tile_t *t) {
+  int32_t tx = t->x - (int)tile_offset.x, ty = t->y - (int)tile_offset.y;
+  if(tx < 0 || ty < 0 || tx + t->w > SIZE || ty + t->h > SIZE) {
+    offset_tiles_outside++;
+    return;
+  }
+  for(int32_t y = 0; y < t->h; y++) {
+    for(int32_t x = 0; x < t->w; x++) {
+      target[ty + y][tx + x] = t->data[x + y * t->stride];
+    }
+  }
+}
+
+void render(pp_poly_t *poly, uint8_t (*out)[SIZE]) {
+  memset(out, 0, SIZE * SIZE);
+  target = out;
+  pp_render(poly);
+}
+
+// -- reference rasteriser ----------------------------------------------------
+//
+// even-odd coverage of each pixel computed from the exact (transformed but not
+// snapped) edges. each pixel row is split into REF_ROWS sub-rows and the
+// horizontal overlap of every span with every pixel is measured exactly
+
+typedef struct {double x0, y0, x1, y1;} ref_edge_t;
+ref_edge_t ref_edges[MAX_POINTS];
+int ref_edge_count;
+
+int compare_double(const void *a, const void *b) {
+  double da = *(const double *)a, db = *(const double *)b;
+  return (da > db) - (da < db);
+}
+
+void reference_edges(pp_poly_t *poly, pp_mat3_t *m) {
+  ref_edge_count = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) {
+    for(int i = 0; i < path->count; i++) {
+      pp_point_t a = path->points[i], b = path->points[(i + 1) % path->count];
+      double ax = a.x, ay = a.y, bx = b.x, by = b.y;
+      if(m) {
+        double tx = m->v00 * ax + m->v01 * ay + m->v02, ty = m->v10 * ax + m->v11 * ay + m->v12;
+        ax = tx; ay = ty;
+        tx = m->v00 * bx + m->v01 * by + m->v02; ty = m->v10 * bx + m->v11 * by + m->v12;
+        bx = tx; by = ty;
+      }
+      ref_edges[ref_edge_count++] = (ref_edge_t){ax, ay, bx, by};
+    }
+  }
+}
+
+void reference_render() {
+  memset(reference, 0, sizeof(reference));
+  double xs[MAX_POINTS];
+  for(int py = 0; py < SIZE; py++) {
+    for(int j = 0; j < REF_ROWS; j++) {
+      double y = py + (j + 0.5) / REF_ROWS;
+      int n = 0;
+      for(int i = 0; i < ref_edge_count; i++) {
+        ref_edge_t *e = &ref_edges[i];
+        double y0 = fmin(e->y0, e->y1), y1 = fmax(e->y0, e->y1);
+        if(y < y0 || y >= y1) continue;
+        xs[n++] = e->x0 + (y - e->y0) * (e->x1 - e->x0) / (e->y1 - e->y0);
+      }
+      qsort(xs, n, sizeof(double), compare_double);
+      for(int i = 0; i + 1 < n; i += 2) {
+        double sx = fmax(xs[i], 0), ex = fmin(xs[i + 1], SIZE);
+        for(int px = (int)floor(sx); px < ex && px < SIZE; px++) {
+          if(px < 0) continue;
+          reference[py][px] += (fmin(ex, px + 1) - fmax(sx, px)) / REF_ROWS;
+        }
+      }
+    }
+  }
+}
+
+// -- random cases ------------------------------------------------------------
+
+pp_poly_t *random_poly(int snap) {
+  pp_poly_t *poly = pp_poly_new();
+  int paths = fuzz_range(1, 3), budget = MAX_POINTS;
+  for(int p = 0; p < paths && budget >= 3; p++) {
+    pp_path_t *path = pp_poly_add_path(poly);
+    int count = fuzz_range(3, _pp_min(budget - (paths - p - 1) * 3, 16));
+    budget -= count;
+
+    // either a star-ish loop around a centre or scattered points (self
+    // intersecting), sometimes near axis aligned
+    double cx = fuzz_randf() * SIZE, cy = fuzz_randf() * SIZE, r = 4 + fuzz_randf() * SIZE / 2;
+    bool scatter = fuzz_rand() & 1;
+    for(int i = 0; i < count; i++) {
+      double x, y;
+      if(scatter) {
+        x = cx + (fuzz_randf() - 0.5) * r * 2; y = cy + (fuzz_randf() - 0.5) * r * 2;
+      } else {
+        double a = (i + fuzz_randf() * 0.8) / count * 2 * M_PI, d = r * (0.3 + fuzz_randf() * 0.7);
+        x = cx + cos(a) * d; y = cy + sin(a) * d;
+      }
+      if(snap == 1) { x = round(x); y = round(y); }
+      if(snap == 2) { x = round(x * 4) / 4; y = round(y * 4) / 4; }
+      pp_path_add_point(path, (pp_point_t){x, y});
+    }
+  }
+  return poly;
+}
+
+// -- checks ------------------------------------------------------------------
+
+int failures = 0;
+int iteration;
+uint32_t case_seed;
+
+void fail(const char *what, int x, int y, int got, int want) {
+  printf("FAIL %s at %d, %d (got %d, expected %d) iteration %d seed %u aa %d\n",
+    what, x, y, got, want, iteration, case_seed, _pp_antialias);
+  failures++;
+}
+
+// tolerances in alpha units for pixels near an edge, see header. an edge 
+// displaced by two sub-samples moves by 2/1, 2/2, 2/4, and 2/8 of a pixel at
+// NONE, X4, X16, and X8 respectively (plus up to one sub-scanline vertically)
+int edge_tolerance(pp_antialias_t aa) {
+  switch(aa) {
+    case PP_AA_X16:  return 192;
+    case PP_AA_X8:   return 128;
+    default:         return 255;  // an edge can move a whole pixel, see check_samples()
+  }
+}
+
+// mean error over all pixels near an edge in one render, catches systematic
+// errors like a span or sub-scanline being shifted
+double mean_tolerance(pp_antialias_t aa) {
+  switch(aa) {
+    case PP_AA_NONE: return 96;
+    case PP_AA_X4:   return 64;
+    case PP_AA_X16:  return 32;
+    case PP_AA_X8:   return 24;
+    default:         return 96;
+  }
+}
+
+double max_error_seen[4], mean_error_seen[4];
+int sample_pixels_checked[4];
+
+// pixels within `r` of an edge, anywhere else is stable and must be entirely
+// inside (255) or outside (0) the polygon
+uint8_t near_edge[SIZE][SIZE];
+
+void mark_edges(int r) {
+  memset(near_edge, 0, sizeof(near_edge));
+  for(int i = 0; i < ref_edge_count; i++) {
+    ref_edge_t *e = &ref_edges[i];
+    int steps = (int)ceil(hypot(e->x1 - e->x0, e->y1 - e->y0) * 4) + 1;
+    for(int j = 0; j <= steps; j++) {
+      double t = (double)j / steps;
+      int px = (int)floor(e->x0 + (e->x1 - e->x0) * t), py = (int)floor(e->y0 + (e->y1 - e->y0) * t);
+      for(int y = _pp_max(py - r, 0); y <= _pp_min(py + r, SIZE - 1); y++) {
+        for(int x = _pp_max(px - r, 0); x <= _pp_min(px + r, SIZE - 1); x++) {
+          near_edge[y][x] = 1;
+        }
+      }
+    }
+  }
+}
+
+void check_coverage(pp_antialias_t aa) {
+  // edges may be displaced by up to two sub-samples, two pixels without
+  // antialiasing and a pixel at X4
+  mark_edges(aa == PP_AA_NONE ? 2 : 1);
+
+  int edge_pixels = 0;
+  double total_error = 0;
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      int want = (int)(reference[y][x] * 255.0 + 0.5), got = canvas[y][x];
+      if(!near_edge[y][x]) {
+        if(got != want) fail("stable pixel", x, y, got, want);
+        continue;
+      }
+
+      int error = abs(got - want);
+      edge_pixels++;
+      total_error += error;
+      if(error > max_error_seen[aa]) max_error_seen[aa] = error;
+      if(error > edge_tolerance(aa)) fail("edge pixel", x, y, got, want);
+    }
+  }
+
+  if(edge_pixels) {
+    double mean = total_error / edge_pixels;
+    if(mean > mean_error_seen[aa]) mean_error_seen[aa] = mean;
+    if(mean > mean_tolerance(aa)) fail("mean edge error", 0, 0, (int)mean, (int)mean_tolerance(aa));
+  }
+}
+
+// even-odd inside test of the reference polygon at (x, y)
+bool reference_inside(double x, double y) {
+  bool inside = false;
+  for(int i = 0; i < ref_edge_count; i++) {
+    ref_edge_t *e = &ref_edges[i];
+    if((e->y0 > y) != (e->y1 > y) && x < e->x0 + (y - e->y0) * (e->x1 - e->x0) / (e->y1 - e->y0)) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+// distance from (x, y) to the nearest reference edge
+double reference_distance(double x, double y) {
+  double nearest = INFINITY;
+  for(int i = 0; i < ref_edge_count; i++) {
+    ref_edge_t *e = &ref_edges[i];
+    double dx = e->x1 - e->x0, dy = e->y1 - e->y0, l = dx * dx + dy * dy;
+    double t = l > 0 ? fmax(0, fmin(1, ((x - e->x0) * dx + (y - e->y0) * dy) / l)) : 0;
+    nearest = fmin(nearest, hypot(x - e->x0 - dx * t, y - e->y0 - dy * t));
+  }
+  return nearest;
+}
+
+// at X1 and X4 the n x n samples of each pixel are taken somewhere in their
+// cell of the sub-sample grid from edges displaced by up to two sub-samples.
+// a sample whose cell centre is further than that (plus the distance from the
+// centre to a corner of the cell) from every edge is certain and must match
+// the reference at the centre, the rest can go either way. the count of
+// covered samples in the output must lie between the certain inside samples
+// and those plus the uncertain ones
+void check_samples(pp_antialias_t aa) {
+  int n = 1 << aa;
+  double d = (2 + M_SQRT1_2) / n;
+
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      if(!near_edge[y][x]) continue;
+
+      int got = (canvas[y][x] * n * n + 127) / 255; // covered samples
+      int inside = 0, uncertain = 0;
+      for(int j = 0; j < n; j++) {
+        for(int i = 0; i < n; i++) {
+          double sx = x + (i + 0.5) / n, sy = y + (j + 0.5) / n;
+          if(reference_distance(sx, sy) <= d) uncertain++;
+          else if(reference_inside(sx, sy)) inside++;
+        }
+      }
+      sample_pixels_checked[aa]++;
+      if(got < inside || got > inside + uncertain) {
+        fail("edge samples", x, y, got, got < inside ? inside : inside + uncertain);
+        return;
+      }
+    }
+  }
+}
+
+uint8_t tile_buffer_b[64 * 64];
+
+void check_seams(pp_poly_t *poly) {
+  // render again with a random tile shape, the output must be identical
+  int w = fuzz_range(1, 64), h = fuzz_range(1, 4096 / w);
+  h = _pp_min(h, 64);
+  pp_tile_buffer(tile_buffer_b, w, h);
+  render(poly, canvas_b);
+  pp_tile_buffer(NULL, 0, 0);
+
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      if(canvas[y][x] != canvas_b[y][x]) {
+        printf("  tile shape %d x %d\n", w, h);
+        fail("seam", x, y, canvas_b[y][x], canvas[y][x]);
+        return;
+      }
+    }
+  }
+}
+
+void check_clip(pp_poly_t *poly) {
+  int cx = fuzz_range(0, SIZE - 1), cy = fuzz_range(0, SIZE - 1);
+  int cw = fuzz_range(1, SIZE - cx), ch = fuzz_range(1, SIZE - cy);
+  pp_clip(cx, cy, cw, ch);
+  render(poly, canvas_b);
+  pp_clip(0, 0, SIZE, SIZE);
+
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      bool inside = x >= cx && x < cx + cw && y >= cy && y < cy + ch;
+      int want = inside ? canvas[y][x] : 0;
+      if(canvas_b[y][x] != want) {
+        printf("  clip %d, %d (%d x %d)\n", cx, cy, cw, ch);
+        fail("clip", x, y, canvas_b[y][x], want);
+        return;
+      }
+    }
+  }
+}
+
+void check_canvas(pp_poly_t *poly) {
+  // start from garbage, everything inside the returned bounds is overwritten
+  memset(canvas_b, 0xa5, sizeof(canvas_b));
+  pp_rect_t b = pp_render_canvas(poly, &canvas_b[0][0], SIZE, SIZE);
+
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      bool inside = x >= b.x && x < b.x + b.w && y >= b.y && y < b.y + b.h;
+      int got = inside ? canvas_b[y][x] : 0;
+      if(got != canvas[y][x] || (!inside && canvas_b[y][x] != 0xa5)) {
+        printf("  canvas bounds %d, %d (%d x %d)\n", b.x, b.y, b.w, b.h);
+        fail("canvas", x, y, canvas_b[y][x], canvas[y][x]);
+        return;
+      }
+    }
+  }
+}
+
+void check_region(pp_poly_t *poly) {
+  static uint8_t covered[SIZE][SIZE];
+  memset(covered, 0, sizeof(covered));
+
+  pp_region_t *region = pp_region_new();
+  int count = fuzz_range(1, 6);
+  for(int i = 0; i < count; i++) {
+    pp_rect_t r = {fuzz_range(-8, SIZE), fuzz_range(-8, SIZE), fuzz_range(0, SIZE / 2), fuzz_range(0, SIZE / 2)};
+    pp_region_add(region, r);
+    for(int y = _pp_max(r.y, 0); y < _pp_min(r.y + r.h, SIZE); y++) {
+      for(int x = _pp_max(r.x, 0); x < _pp_min(r.x + r.w, SIZE); x++) covered[y][x] = 1;
+    }
+  }
+
+  // count the region rects over each pixel, must be one inside and none outside
+  for(int i = 0; i < region->count; i++) {
+    pp_rect_t *r = &region->rects[i];
+    for(int y = _pp_max(r->y, 0); y < _pp_min(r->y + r->h, SIZE); y++) {
+      for(int x = _pp_max(r->x, 0); x < _pp_min(r->x + r->w, SIZE); x++) covered[y][x] += 2;
+    }
+  }
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      if(covered[y][x] != 0 && covered[y][x] != 3) {
+        fail("region rects", x, y, covered[y][x] >> 1, covered[y][x] & 1);
+        pp_region_free(region);
+        return;
+      }
+    }
+  }
+
+  // tiled, then straight into a canvas
+  for(int pass = 0; pass < 2; pass++) {
+    memset(canvas_b, 0xa5, sizeof(canvas_b));
+    target = canvas_b;
+    pp_clip_region(region);
+    if(pass == 0) pp_render(poly); else pp_render_canvas(poly, &canvas_b[0][0], SIZE, SIZE);
+    pp_clip_region(NULL);
+
+    for(int y = 0; y < SIZE; y++) {
+      for(int x = 0; x < SIZE; x++) {
+        int want = covered[y][x] ? canvas[y][x] : 0xa5;
+        int got = covered[y][x] && canvas_b[y][x] == 0xa5 ? 0 : canvas_b[y][x]; // untouched inside is empty
+        if(got != want && !(covered[y][x] && canvas_b[y][x] == want)) {
+          fail(pass ? "region canvas" : "region", x, y, canvas_b[y][x], want);
+          pp_region_free(region);
+          return;
+        }
+      }
+    }
+  }
+  pp_region_free(region);
+}
+
+// prepare the polygon moved far from the origin, where tile positions no longer
+// fit in 16 bits, and compare its replay with pp_render() at the same place
+void check_prepared_offset(pp_poly_t *poly) {
+  tile_offset = (pp_point_t){fuzz_range(40000, 1 << 20), fuzz_range(40000, 1 << 20)};
+  if(fuzz_rand() & 1) tile_offset.x = -tile_offset.x;
+  if(fuzz_rand() & 1) tile_offset.y = -tile_offset.y;
+
+  pp_mat3_t *old = _pp_transform, m = pp_mat3_identity();
+  pp_mat3_translate(&m, tile_offset.x, tile_offset.y);
+  if(old) pp_mat3_mul(&m, old);
+  pp_transform(&m);
+  pp_clip(tile_offset.x, tile_offset.y, SIZE, SIZE);
+  pp_tile_callback(copy_offset_tile);
+
+  render(poly, canvas_b);
+
+  pp_prepared_t *prepared = pp_prepare(poly);
+  size_t size = pp_prepared_save(prepared, NULL);
+  uint8_t *data = malloc(size);
+  pp_prepared_save(prepared, data);
+  pp_prepared_free(prepared);
+  prepared = pp_prepared_load(data, size);
+  free(data);
+  bool loaded = prepared != NULL;
+
+  static uint8_t replayed[SIZE][SIZE];
+  memset(replayed, 0, sizeof(replayed));
+  target = replayed;
+  if(loaded) {
+    pp_render_prepared(prepared);
+    pp_prepared_free(prepared);
+  } else {
+    fail("prepared offset load", tile_offset.x, tile_offset.y, 0, 0);
+  }
+
+  pp_tile_callback(copy_tile);
+  pp_clip(0, 0, SIZE, SIZE);
+  pp_transform(old);
+
+  if(offset_tiles_outside) {
+    fail("prepared offset tiles outside clip", tile_offset.x, tile_offset.y, offset_tiles_outside, 0);
+    offset_tiles_outside = 0;
+    return;
+  }
+
+  for(int y = 0; y < SIZE && loaded; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      if(replayed[y][x] != canvas_b[y][x]) {
+        fail("prepared offset", x, y, replayed[y][x], canvas_b[y][x]);
+        return;
+      }
+    }
+  }
+}
+
+void check_prepared(pp_poly_t *poly) {
+  pp_prepared_t *prepared = pp_prepare(poly);
+  size_t size = pp_prepared_save(prepared, NULL);
+  uint8_t *data = malloc(size);
+  pp_prepared_save(prepared, data);
+  pp_prepared_free(prepared);
+
+  prepared = pp_prepared_load(data, size);
+  if(!prepared) {
+    fail("prepared load", 0, 0, 0, 0);
+    free(data);
+    return;
+  }
+  memset(canvas_b, 0, sizeof(canvas_b));
+  target = canvas_b;
+  pp_render_prepared(prepared);
+  pp_prepared_free(prepared);
+
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      if(canvas_b[y][x] != canvas[y][x]) {
+        fail("prepared", x, y, canvas_b[y][x], canvas[y][x]);
+        free(data);
+        return;
+      }
+    }
+  }
+
+  // corrupt tiles can be anywhere on screen so they are discarded
+  data[fuzz_range(0, size - 1)] ^= 1 << fuzz_range(0, 7);
+  prepared = pp_prepared_load(data, size);
+  if(prepared) {
+    pp_tile_callback(discard_tile);
+    pp_render_prepared(prepared);
+    pp_tile_callback(copy_tile);
+    pp_prepared_free(prepared);
+  }
+  free(data);
+
+  check_prepared_offset(poly);
+}
+
+void check_clip_path(pp_poly_t *poly) {
+  static uint8_t clip[SIZE][SIZE];
+
+  // coverage of the clip polygon at the antialias level the polygon used
+  pp_antialias_t antialias = _pp_antialias;
+  pp_mat3_t *transform = pp_transform(NULL);
+  pp_poly_t *clip_poly = random_poly(fuzz_range(0, 2));
+  pp_antialias(_pp_aa);
+  render(clip_poly, clip);
+  pp_antialias(antialias);
+  pp_transform(transform);
+
+  int w = fuzz_range(1, 64), h = _pp_min(fuzz_range(1, 4096 / w), 64);
+  pp_tile_buffer(tile_buffer_b, w, h);
+  pp_clip_path(clip_poly);
+  for(int pass = 0; pass < 2; pass++) {
+    render(poly, canvas_b);
+    for(int y = 0; y < SIZE; y++) {
+      for(int x = 0; x < SIZE; x++) {
+        int want = (canvas[y][x] * clip[y][x] + 127) / 255;
+        if(canvas_b[y][x] != want) {
+          printf("  tile shape %d x %d, pass %d\n", w, h, pass);
+          fail("clip path", x, y, canvas_b[y][x], want);
+          pass = 2; y = SIZE;
+          break;
+        }
+      }
+    }
+  }
+  pp_clip_path(NULL);
+  pp_tile_buffer(NULL, 0, 0);
+  pp_poly_free(clip_poly);
+}
+
+// even-odd inside test of a path, or of every path of a polygon if `all`
+bool inside_path(pp_path_t *path, bool all, double x, double y) {
+  bool inside = false;
+  for(; path; path = all ? path->next : NULL) {
+    pp_point_t *p = path->points;
+    for(int i = 0, j = path->count - 1; i < path->count; j = i++) {
+      if((p[i].y > y) != (p[j].y > y) &&
+         x < p[j].x + (y - p[j].y) * (p[i].x - p[j].x) / (p[i].y - p[j].y)) inside = !inside;
+    }
+  }
+  return inside;
+}
+
+// distance from x, y to the nearest edge of a path (or every path)
+double edge_distance(pp_path_t *path, bool all, double x, double y) {
+  double best = 1e9;
+  for(; path; path = all ? path->next : NULL) {
+    pp_point_t *p = path->points;
+    for(int i = 0, j = path->count - 1; i < path->count; j = i++) {
+      double dx = p[i].x - p[j].x, dy = p[i].y - p[j].y, l = dx * dx + dy * dy;
+      double t = l > 0 ? ((x - p[j].x) * dx + (y - p[j].y) * dy) / l : 0;
+      t = t < 0 ? 0 : t > 1 ? 1 : t;
+      double ex = p[j].x + t * dx - x, ey = p[j].y + t * dy - y;
+      best = fmin(best, sqrt(ex * ex + ey * ey));
+    }
+  }
+  return best;
+}
+
+bool redundant_points(pp_poly_t *poly) {
+  for(pp_path_t *path = poly->paths; path; path = path->next) {
+    if(path->count < 3) return true;
+    pp_point_t *p = path->points;
+    for(int i = 0; i < path->count; i++) {
+      pp_point_t a = p[(i + path->count - 1) % path->count], b = p[i], c = p[(i + 1) % path->count];
+      if((double)(b.x - a.x) * (c.y - a.y) - (double)(b.y - a.y) * (c.x - a.x) == 0) return true;
+    }
+  }
+  return false;
+}
+
+void check_boolean(pp_poly_t *poly) {
+  static const char *names[] = {"union", "intersection", "difference", "xor"};
+  pp_poly_t *other = random_poly(fuzz_range(0, 2));
+  pp_boolean_t op = fuzz_range(0, 3);
+  pp_poly_t *result = pp_poly_boolean(poly, other, op);
+
+  // union of copies of the first paths of each
+  pp_poly_t *path_union = pp_poly_new(), *second = pp_poly_new();
+  pp_path_add_points(pp_poly_add_path(path_union), poly->paths->points, poly->paths->count);
+  pp_path_add_points(pp_poly_add_path(second), other->paths->points, other->paths->count);
+  pp_path_union(path_union->paths, second->paths);
+  pp_poly_free(second);
+
+  if(redundant_points(result)) fail("boolean redundant points", 0, 0, 0, 0);
+
+  for(int i = 0; i < 2000; i++) {
+    double x = fuzz_randf() * SIZE, y = fuzz_randf() * SIZE;
+    if(edge_distance(poly->paths, true, x, y) < 0.02 || edge_distance(other->paths, true, x, y) < 0.02) continue;
+
+    bool a = inside_path(poly->paths, true, x, y), b = inside_path(other->paths, true, x, y);
+    bool want = op == PP_UNION ? a || b : op == PP_INTERSECTION ? a && b : op == PP_DIFFERENCE ? a && !b : a != b;
+    if(inside_path(result->paths, true, x, y) != want) {
+      printf("  %s at %f, %f\n", names[op], x, y);
+      fail("boolean", (int)x, (int)y, !want, want);
+      break;
+    }
+
+    if(edge_distance(poly->paths, false, x, y) < 0.02 || edge_distance(other->paths, false, x, y) < 0.02) continue;
+    want = inside_path(poly->paths, false, x, y) || inside_path(other->paths, false, x, y);
+    if(inside_path(path_union->paths, true, x, y) != want) {
+      printf("  path union at %f, %f\n", x, y);
+      fail("path union", (int)x, (int)y, !want, want);
+      break;
+    }
+  }
+
+  pp_poly_free(result);
+  pp_poly_free(path_union);
+  pp_poly_free(other);
+}
+
+// distance in pixels of point `m` from the segment `i` to `j` of `path` once
+// transformed by the current transform
+double device_distance(pp_path_t *path, int m, int i, int j) {
+  pp_point_t p = path->points[m], a = path->points[i], b = path->points[j];
+  if(_pp_transform) {
+    p = pp_point_transform(&p, _pp_transform);
+    a = pp_point_transform(&a, _pp_transform);
+    b = pp_point_transform(&b, _pp_transform);
+  }
+  double dx = b.x - a.x, dy = b.y - a.y, l = dx * dx + dy * dy;
+  double t = l > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / l : 0;
+  t = t < 0 ? 0 : t > 1 ? 1 : t;
+  double ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+  return sqrt(ex * ex + ey * ey);
+}
+
+// indices into `path` of the points of `simple` if it is made of them in order
+bool simplified_from(pp_path_t *path, pp_path_t *simple, int *index) {
+  int i = 0;
+  for(int k = 0; k < simple->count; k++) {
+    while(i < path->count && (path->points[i].x != simple->points[k].x || path->points[i].y != simple->points[k].y)) i++;
+    if(i == path->count) return false;
+    index[k] = i++;
+  }
+  return true;
+}
+
+// checks that `result` is `poly` simplified to within `tolerance` pixels
+void check_simplified(pp_poly_t *poly, pp_poly_t *result, float tolerance) {
+  double slack = 1e-3 * (1 + tolerance);
+  pp_path_t *simple = result->paths;
+  int index[MAX_POINTS];
+  for(pp_path_t *path = poly->paths; path; path = path->next) {
+    if(simple && simple->count >= 3 && simplified_from(path, simple, index)) {
+      for(int k = 0; k < simple->count; k++) {
+        int i = index[k], j = index[(k + 1) % simple->count];
+        for(int m = (i + 1) % path->count; m != j; m = (m + 1) % path->count) {
+          double d = device_distance(path, m, i, j);
+          if(d > tolerance + slack) {
+            printf("  point %d is %f from the simplified contour (tolerance %f)\n", m, d, tolerance);
+            fail("simplify", 0, 0, 0, 0);
+            break;
+          }
+        }
+      }
+      simple = simple->next;
+      continue;
+    }
+
+    // dropped, must be thinner than the tolerance
+    bool thin = false;
+    for(int i = 0; i < path->count && !thin; i++) {
+      for(int j = 0; j < path->count && !thin; j++) {
+        thin = true;
+        for(int m = 0; m < path->count && thin; m++) {
+          thin = device_distance(path, m, i, j) <= tolerance + slack;
+        }
+      }
+    }
+    if(!thin) {
+      printf("  contour of %d points dropped (tolerance %f)\n", path->count, tolerance);
+      fail("simplify", 0, 0, 0, 0);
+    }
+  }
+  if(simple) fail("simplify extra contours", 0, 0, 0, 0);
+}
+
+void check_simplify(pp_poly_t *poly) {
+  const float tolerances[] = {0.0f, 0.25f, 1.0f, 4.0f};
+  float tolerance = tolerances[fuzz_range(0, 3)];
+  pp_poly_t *result = pp_poly_simplify(poly, tolerance);
+  check_simplified(poly, result, tolerance);
+  pp_poly_free(result);
+}
+
+void check_lod(pp_poly_t *poly) {
+  static uint8_t without[SIZE][SIZE];
+  render(poly, without);
+  pp_poly_lod_t *lod = pp_poly_lod_new(poly, fuzz_range(1, 12));
+
+  // each level coarser than the last, and within its error on screen. the
+  // largest a transform scales a length by is the root of the largest
+  // eigenvalue of its transpose times itself
+  double scale = 1;
+  if(_pp_transform) {
+    pp_mat3_t *m = _pp_transform;
+    double p = m->v00 * m->v00 + m->v10 * m->v10, r = m->v01 * m->v01 + m->v11 * m->v11;
+    double q = m->v00 * m->v01 + m->v10 * m->v11;
+    scale = sqrt((p + r) / 2 + sqrt((p - r) * (p - r) / 4 + q * q));
+  }
+  int edges = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) edges += path->count;
+  float error = 0.0f;
+  for(pp_lod_level_t *level = lod->levels; level; level = level->next) {
+    int count = 0;
+    for(pp_path_t *path = level->poly->paths; path; path = path->next) count += path->count;
+    if(count >= edges || level->error <= error) fail("lod order", 0, 0, count, edges);
+    edges = count;
+    error = level->error;
+    check_simplified(poly, level->poly, level->error * scale);
+  }
+
+  // the level drawn must be within the threshold, with no threshold it must
+  // be the polygon itself
+  pp_poly_t *selected = pp_poly_lod_select(lod);
+  for(pp_lod_level_t *level = lod->levels; level; level = level->next) {
+    if(level->poly == selected && level->error * scale > _pp_lod_threshold + 1e-4) {
+      fail("lod threshold", 0, 0, (int)(level->error * scale * 1000), (int)(_pp_lod_threshold * 1000));
+    }
+  }
+
+  pp_lod_threshold(0.0f);
+  render(pp_poly_lod_select(lod), canvas_b);
+  pp_lod_threshold(0.25f);
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      if(without[y][x] != canvas_b[y][x]) {
+        fail("lod disabled", x, y, canvas_b[y][x], without[y][x]);
+        y = SIZE;
+        break;
+      }
+    }
+  }
+
+  // levels made before the polygon changed must not be drawn
+  if(selected != poly) {
+    pp_path_t *tail = pp_poly_tail_path(poly);
+    pp_path_add_point(tail, (pp_point_t){0, 0});
+    if(pp_poly_lod_select(lod) != poly) fail("lod out of date", 0, 0, 0, 0);
+    tail->count--;
+  }
+
+  pp_poly_lod_free(lod);
+}
+
+// counts tiles drawn entirely over hidden pixels, which should be skipped
+uint8_t hidden[SIZE][SIZE];
+int hidden_tiles;
+void copy_unhidden_tile(const pp_tile_t *t) {
+  bool all = true;
+  for(int32_t y = 0; y < t->h; y++) {
+    for(int32_t x = 0; x < t->w; x++) all = all && hidden[t->y + y][t->x + x];
+  }
+  hidden_tiles += all;
+  copy_tile(t);
+}
+
+void check_occlusion(pp_poly_t *poly) {
+  pp_occlusion_t *occlusion = pp_occlusion_new(SIZE, SIZE);
+  pp_rect_t hide[4];
+  memset(hidden, 0, sizeof(hidden));
+  int count = fuzz_range(0, 4);
+  for(int i = 0; i < count; i++) {
+    int rx = fuzz_range(0, SIZE - 1), ry = fuzz_range(0, SIZE - 1);
+    int rw = fuzz_range(1, SIZE - rx), rh = fuzz_range(1, SIZE - ry);
+    hide[i] = (pp_rect_t){rx, ry, rw, rh};
+    for(int y = ry; y < ry + rh; y++) {
+      for(int x = rx; x < rx + rw; x++) hidden[y][x] = 1;
+    }
+  }
+
+  // tiled, then straight into a canvas with the mask as it was
+  bool ok = true;
+  for(int pass = 0; pass < 2 && ok; pass++) {
+    pp_occlusion_clear(occlusion);
+    for(int i = 0; i < count; i++) pp_occlusion_hide(occlusion, hide[i]);
+    pp_occlusion(occlusion);
+    pp_opaque(true);
+    if(pass == 0) {
+      hidden_tiles = 0;
+      pp_tile_callback(copy_unhidden_tile);
+      render(poly, canvas_b);
+      pp_tile_callback(copy_tile);
+      if(hidden_tiles) {
+        fail("occlusion hidden tiles", 0, 0, hidden_tiles, 0);
+        ok = false;
+      }
+    } else {
+      memset(canvas_b, 0, sizeof(canvas_b));
+      pp_render_canvas(poly, &canvas_b[0][0], SIZE, SIZE);
+    }
+    pp_opaque(false);
+    pp_occlusion(NULL);
+
+    for(int y = 0; y < SIZE && ok; y++) {
+      for(int x = 0; x < SIZE && ok; x++) {
+        int want = hidden[y][x] ? 0 : canvas[y][x];
+        bool now_hidden = (occlusion->bits[y * occlusion->stride + (x >> 3)] >> (7 - (x & 7))) & 1;
+        if(canvas_b[y][x] != want) {
+          fail(pass ? "occlusion canvas" : "occlusion", x, y, canvas_b[y][x], want);
+          ok = false;
+        } else if(now_hidden != (hidden[y][x] || canvas[y][x] == 255)) {
+          fail(pass ? "occlusion canvas mask" : "occlusion mask", x, y, now_hidden, !now_hidden);
+          ok = false;
+        } else if(now_hidden && (x < occlusion->spans[y * 2] || x > occlusion->spans[y * 2 + 1])) {
+          fail(pass ? "occlusion canvas span" : "occlusion span", x, y, occlusion->spans[y * 2], occlusion->spans[y * 2 + 1]);
+          ok = false;
+        }
+      }
+    }
+  }
+  pp_occlusion_free(occlusion);
+}
+
+// expands packed tiles, counting tiles with the wrong stride or with bits
+// set past the end of a row
+int packed_bad_stride = 0, packed_stray_bits = 0;
+void copy_packed_tile(const pp_tile_t *t) {
+  int32_t stride = t->format == PP_TILE_4BPP ? (_pp_tile_w + 1) >> 1 : (_pp_tile_w + 7) >> 3;
+  packed_bad_stride += (int32_t)t->stride != stride;
+  int bpp = t->format == PP_TILE_4BPP ? 4 : 1, used = (t->w * bpp) & 7;
+  for(int32_t y = 0; y < t->h; y++) {
+    if(used && t->data[y * t->stride + ((t->w * bpp) >> 3)] & (0xff >> used)) packed_stray_bits++;
+    for(int32_t x = 0; x < t->w; x++) {
+      target[t->y + y][t->x + x] = pp_tile_get(t, t->x + x, t->y + y);
+    }
+  }
+}
+
+void check_packed(pp_poly_t *poly) {
+  static const uint8_t bayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+  const pp_tile_format_t formats[] = {PP_TILE_4BPP, PP_TILE_1BPP, PP_TILE_1BPP_DITHER};
+  pp_tile_format_t format = formats[fuzz_range(0, 2)];
+
+  // at X1 only the packed rows of a 1bpp tile buffer are used, anything
+  // written past them lands in the guard bytes
+  int w = fuzz_range(1, 128), h = fuzz_range(1, 64);
+  bool bits = _pp_antialias == PP_AA_NONE && format != PP_TILE_4BPP;
+  size_t size = bits ? ((w + 7) >> 3) * h : w * h;
+  uint8_t *buffer = malloc(size + 64);
+  memset(buffer + size, 0xa5, 64);
+
+  packed_bad_stride = packed_stray_bits = 0;
+  pp_tile_buffer(buffer, w, h);
+  pp_tile_format(format);
+  pp_tile_callback(copy_packed_tile);
+  render(poly, canvas_b);
+  pp_tile_callback(copy_tile);
+  pp_tile_format(PP_TILE_8BPP);
+  pp_tile_buffer(NULL, 0, 0);
+
+  for(int i = 0; i < 64; i++) {
+    if(buffer[size + i] != 0xa5) {
+      printf("  tile shape %d x %d\n", w, h);
+      fail("packed buffer overrun", i, 0, buffer[size + i], 0xa5);
+      break;
+    }
+  }
+  free(buffer);
+  if(packed_bad_stride) fail("packed stride", 0, 0, packed_bad_stride, 0);
+  if(packed_stray_bits) fail("packed stray bits", 0, 0, packed_stray_bits, 0);
+
+  for(int y = 0; y < SIZE; y++) {
+    for(int x = 0; x < SIZE; x++) {
+      int a = canvas[y][x], want;
+      switch(format) {
+        case PP_TILE_4BPP: want = (a >> 4) * 17; break;
+        case PP_TILE_1BPP: want = a >= 128 ? 255 : 0; break;
+        default: want = a >= bayer[y & 3][x & 3] * 16 + 8 ? 255 : 0; break;
+      }
+      if(canvas_b[y][x] != want) {
+        printf("  tile shape %d x %d, format %d\n", w, h, format);
+        fail("packed", x, y, canvas_b[y][x], want);
+        return;
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 1000;
+  uint32_t base_seed = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 1;
+
+  pp_tile_callback(copy_tile);
+  pp_clip(0, 0, SIZE, SIZE);
+
+  const pp_antialias_t levels[] = {PP_AA_NONE, PP_AA_X4, PP_AA_X8, PP_AA_X16, PP_AA_AUTO};
+
+  for(iteration = 0; iteration < iterations; iteration++) {
+    case_seed = base_seed * 2654435761u + iteration;
+    seed = case_seed | 1;
+
+    pp_poly_t *poly = random_poly(fuzz_range(0, 2));
+
+    // random transform about half of the time
+    pp_mat3_t m = pp_mat3_identity();
+    bool transformed = fuzz_rand() & 1;
+    if(transformed) {
+      pp_mat3_translate(&m, SIZE / 2, SIZE / 2);
+      pp_mat3_rotate(&m, fuzz_randf() * 360);
+      float s = 0.25f + fuzz_randf() * 1.5f;
+      pp_mat3_scale(&m, s, s * (0.5f + fuzz_randf()));
+      pp_mat3_translate(&m, -SIZE / 2, -SIZE / 2);
+    }
+    pp_transform(transformed ? &m : NULL);
+
+    reference_edges(poly, transformed ? &m : NULL);
+    reference_render();
+
+    pp_antialias_t aa = levels[iteration % 5];
+    pp_antialias(aa);
+    render(poly, canvas);
+
+    // coverage is compared at fixed levels, with PP_AA_AUTO the level chosen
+    // is covered by the seam and clip checks
+    if(aa != PP_AA_AUTO) check_coverage(aa);
+    if(aa == PP_AA_NONE || aa == PP_AA_X4) check_samples(aa);
+    check_seams(poly);
+    check_clip(poly);
+    check_canvas(poly);
+    check_region(poly);
+    check_prepared(poly);
+    check_clip_path(poly);
+    check_boolean(poly);
+    check_simplify(poly);
+    check_lod(poly);
+    check_occlusion(poly);
+    check_packed(poly);
+
+    pp_transform(NULL);
+    pp_poly_free(poly);
+
+    if(failures > 20) break;
+  }
+
+  if(tile_aa_mismatch) {
+    printf("FAIL %d tiles reported the wrong antialias level\n", tile_aa_mismatch);
+    failures++;
+  }
+
+  const char *names[] = {"none", "x4", "x16", "x8"};
+  for(int i = 0; i < 4; i++) {
+    printf("%-4s max edge error %3d (tolerance %3d), worst mean edge error %5.1f (tolerance %3.0f)\n",
+      names[i], (int)max_error_seen[i], edge_tolerance(i), mean_error_seen[i], mean_tolerance(i));
+  }
+  printf("none and x4 edge pixels checked per sample: %d, %d\n", sample_pixels_checked[0], sample_pixels_checked[1]);
+  printf("%d iterations, %d failures\n", iteration, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+// pretty poly rasteriser stage benchmark
+//
+// times the individual stages of tile rasterisation in isolation on synthetic
+// edge distributions so that a change in the scene benchmark can be
+// attributed to a single stage:
+//
+//   edges   - add_line_segment_to_nodes() (reported per edge and per node)
+//   sort    - sort_nodes() for every sub-scanline (per node)
+//   fill    - fill_span() for every span (per pixel covered)
+//   resolve - resolve_alpha() over the touched area (per pixel)
+//
+// usage: pp_bench_kernels [milliseconds per measurement]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+
+#define STR(x) #x
+#define XSTR(x) STR(x)
+
+#define MAX_SEGMENTS 4096
+#define MAX_ROWS PP_NODE_BUFFER_HEIGHT
+
+typedef struct {pp_point_t s, e;} segment_t;
+
+segment_t segments[MAX_SEGMENTS];
+int segment_count;
+
+uint64_t min_ns = 50000000; // time each measurement for at least this long
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// -- synthetic edge distributions -------------------------------------------
+//
+// each generator fills `segments` with edges in tile space (pixels) covering a
+// tile of w x h pixels, the edges form closed loops so spans pair up properly
+
+void add_segment(float sx, float sy, float ex, float ey) {
+  if(segment_count < MAX_SEGMENTS) {
+    segments[segment_count++] = (segment_t){{sx, sy}, {ex, ey}};
+  }
+}
+
+// a loop through the given points
+void add_loop(pp_point_t *p, int count) {
+  for(int i = 0; i < count; i++) {
+    pp_point_t n = p[(i + 1) % count];
+    add_segment(p[i].x, p[i].y, n.x, n.y);
+  }
+}
+
+// near vertical edges: thin slanted parallelograms side by side
+void gen_steep(int w, int h) {
+  for(int x = 0; x + 6 <= w; x += 8) {
+    pp_point_t p[] = {{x + 0.3f, 0}, {x + 3.7f, 0}, {x + 5.9f, h}, {x + 2.1f, h}};
+    add_loop(p, 4);
+  }
+}
+
+// near horizontal edges: long thin slivers that cross many pixel columns
+// for every sub-scanline
+void gen_shallow(int w, int h) {
+  for(int y = 0; y + 3 <= h; y += 4) {
+    pp_point_t p[] = {{0, y + 0.2f}, {w, y + 2.9f}, {w, y + 3.8f}, {0, y + 1.1f}};
+    add_loop(p, 4);
+  }
+}
+
+// a sawtooth that crosses every sub-scanline `teeth * 2` times
+void gen_crossings(int w, int h, int teeth) {
+  float tw = (float)w / teeth;
+  for(int i = 0; i < teeth; i++) {
+    float x = i * tw;
+    pp_point_t p[] = {{x, 0.5f}, {x + tw * 0.45f, h - 0.5f}, {x + tw * 0.9f, 0.5f}};
+    add_loop(p, 3);
+  }
+}
+
+// the worst case the node buffers accept: PP_MAX_NODES_PER_SCANLINE * 2
+// nodes on every sub-scanline, generated in descending x order and with
+// slopes that reshuffle the order from row to row
+void gen_adversarial(int w, int h) {
+  int n = PP_MAX_NODES_PER_SCANLINE;
+  float tw = (float)w / n;
+  for(int i = n - 1; i >= 0; i--) {
+    float x = i * tw;
+    pp_point_t p[] = {{x + tw * 0.9f, 0}, {x + tw * 0.1f, 0}, {x + tw * 0.8f, h}, {x + tw * 0.2f, h}};
+    add_loop(p, 4);
+  }
+}
+
+// a single rectangle spanning the tile, one very long span per sub-scanline
+void gen_long_spans(int w, int h) {
+  pp_point_t p[] = {{0.25f, 0.5f}, {w - 0.25f, 0.5f}, {w - 0.25f, h - 0.5f}, {0.25f, h - 0.5f}};
+  add_loop(p, 4);
+}
+
+// -- stages ------------------------------------------------------------------
+
+int16_t rows[MAX_ROWS][PP_MAX_NODES_PER_SCANLINE * 2];
+int16_t sorted[MAX_ROWS][PP_MAX_NODES_PER_SCANLINE * 2];
+int row_counts[MAX_ROWS];
+
+typedef struct {
+  double ns_per_edge, ns_per_node;  // edges
+  double sort_ns_per_node;          // sort
+  double fill_ns_per_pixel;         // fill
+  double resolve_ns_per_pixel;      // resolve
+  uint64_t edges, nodes, fill_pixels, resolve_pixels;
+} result_t;
+
+// scale segments into sub-sample space and add them to the node buffers
+void build(pp_rect_t *tb) {
+  float s = (float)(1 << _pp_aa);
+  for(int i = 0; i < segment_count; i++) {
+    pp_point_t a = {segments[i].s.x * s, segments[i].s.y * s};
+    pp_point_t b = {segments[i].e.x * s, segments[i].e.y * s};
+    add_line_segment_to_nodes(a, b, tb);
+  }
+}
+
+result_t run(pp_rect_t tb) {
+  result_t r = {0};
+  int sub_rows = tb.h << _pp_aa;
+  r.edges = segment_count;
+
+  // edges: build the nodes from scratch each iteration
+  uint64_t iterations = 0, start = now_ns(), elapsed;
+  do {
+    build(&tb);
+    reset_nodes();
+    iterations++;
+  } while((elapsed = now_ns() - start) < min_ns);
+  r.ns_per_edge = (double)elapsed / iterations / segment_count;
+
+  // capture the nodes of each sub-scanline for the later stages
+  build(&tb);
+  for(int y = 0; y < sub_rows; y++) {
+    row_counts[y] = node_counts[y] ? gather_nodes(y, rows[y]) : 0;
+    r.nodes += row_counts[y];
+  }
+  reset_nodes();
+  r.ns_per_node = (double)elapsed / iterations / r.nodes;
+
+  // sort: sort a fresh copy of every sub-scanline's nodes
+  iterations = 0; start = now_ns();
+  do {
+    for(int y = 0; y < sub_rows; y++) {
+      memcpy(sorted[y], rows[y], row_counts[y] * sizeof(int16_t));
+      sort_nodes(sorted[y], row_counts[y]);
+    }
+    iterations++;
+  } while((elapsed = now_ns() - start) < min_ns);
+  // remove the cost of the copies
+  start = now_ns();
+  for(uint64_t i = 0; i < iterations; i++) {
+    for(int y = 0; y < sub_rows; y++) {
+      memcpy(sorted[y], rows[y], row_counts[y] * sizeof(int16_t));
+    }
+    __asm__ volatile("" ::: "memory");
+  }
+  elapsed -= _pp_min(elapsed, now_ns() - start);
+  r.sort_ns_per_node = (double)elapsed / iterations / r.nodes;
+  for(int y = 0; y < sub_rows; y++) sort_nodes(sorted[y], row_counts[y]);
+
+  // fill: rasterise the sorted spans, one sub-scanline at a time
+  for(int y = 0; y < sub_rows; y++) {
+    for(int i = 0; i + 1 < row_counts[y]; i += 2) {
+      r.fill_pixels += ((sorted[y][i + 1] - sorted[y][i]) >> _pp_aa) + 1;
+    }
+  }
+  iterations = 0; start = now_ns();
+  do {
+    for(int y = 0; y < sub_rows; y++) {
+      uint8_t *row_data = &_pp_tile_buffer[(y >> _pp_aa) * _pp_tile_w];
+      for(int i = 0; i + 1 < row_counts[y]; i += 2) {
+        if(sorted[y][i] != sorted[y][i + 1]) fill_span(row_data, sorted[y][i], sorted[y][i + 1], y, 1);
+      }
+    }
+    iterations++;
+  } while((elapsed = now_ns() - start) < min_ns);
+  r.fill_ns_per_pixel = (double)elapsed / iterations / r.fill_pixels;
+
+  // resolve: map sample counts to alpha over the whole tile
+  pp_rect_t rb = {0, 0, tb.w, tb.h};
+  r.resolve_pixels = tb.w * tb.h;
+  iterations = 0; start = now_ns();
+  do {
+    resolve_alpha(&rb);
+    iterations++;
+  } while((elapsed = now_ns() - start) < min_ns);
+  r.resolve_ns_per_pixel = (double)elapsed / iterations / r.resolve_pixels;
+
+  memset(_pp_tile_buffer, 0, _pp_tile_w * _pp_tile_h);
+  return r;
+}
+
+int main(int argc, char **argv) {
+  if(argc > 1) min_ns = (uint64_t)atoi(argv[1]) * 1000000;
+
+  const struct {const char *name; pp_antialias_t aa;} levels[] = {
+    {"none", PP_AA_NONE}, {"x4", PP_AA_X4}, {"x8", PP_AA_X8}, {"x16", PP_AA_X16}
+  };
+
+  const char *distributions[] = {
+    "steep", "shallow", "crossings", "adversarial", "long_spans"
+  };
+
+  printf("{\n");
+  printf("  \"variant\": {\"coord_type\": \"%s\", \"tile_buffer_size\": %d, \"max_nodes_per_scanline\": %d},\n",
+    XSTR(PP_COORD_TYPE), PP_TILE_BUFFER_SIZE, PP_MAX_NODES_PER_SCANLINE);
+  printf("  \"results\": [");
+
+  bool first = true;
+  for(size_t d = 0; d < sizeof(distributions) / sizeof(distributions[0]); d++) {
+    for(size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+      _pp_aa = levels[l].aa;
+
+      // full width tile, as tall as the node buffer allows at this level
+      pp_rect_t tb = {0, 0, _pp_tile_w, _pp_min(_pp_tile_h, PP_NODE_BUFFER_HEIGHT >> _pp_aa)};
+
+      segment_count = 0;
+      switch(d) {
+        case 0: gen_steep(tb.w, tb.h); break;
+        case 1: gen_shallow(tb.w, tb.h); break;
+        case 2: gen_crossings(tb.w, tb.h, PP_MAX_NODES_PER_SCANLINE / 2); break;
+        case 3: gen_adversarial(tb.w, tb.h); break;
+        case 4: gen_long_spans(tb.w, tb.h); break;
+      }
+
+      result_t r = run(tb);
+
+      printf("%s\n    {\"distribution\": \"%s\", \"aa\": \"%s\", ", first ? "" : ",", distributions[d], levels[l].name);
+      printf("\"edges\": %llu, \"nodes\": %llu, \"fill_pixels\": %llu, \"resolve_pixels\": %llu, ",
+        (unsigned long long)r.edges, (unsigned long long)r.nodes, (unsigned long long)r.fill_pixels, (unsigned long long)r.resolve_pixels);
+      printf("\"edges_ns_per_edge\": %.2f, \"edges_ns_per_node\": %.3f, \"sort_ns_per_node\": %.3f, ",
+        r.ns_per_edge, r.ns_per_node, r.sort_ns_per_node);
+      printf("\"fill_ns_per_pixel\": %.3f, \"resolve_ns_per_pixel\": %.3f}",
+        r.fill_ns_per_pixel, r.resolve_ns_per_pixel);
+      fflush(stdout);
+      first = false;
+    }
+  }
+
+  printf("\n  ]\n}\n");
+  return 0;
+}
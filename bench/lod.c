@@ -0,0 +1,191 @@
+// pretty poly levels of detail benchmark
+//
+// draws the map scene's coastline and the logo at zooms from full screen down
+// to a thumbnail, first as they are and then with levels of detail from
+// pp_poly_lod_new() so that pp_render_lod() picks the coarsest level within
+// the threshold for each zoom. reports the median time of each, the error and
+// edge count of the level picked, and how many pixels differ as json on
+// stdout. the coverage that changes (in pixels) must be less than the
+// threshold times the length of the outline on screen, otherwise the program
+// exits with a non-zero status
+//
+// usage: pp_bench_lod [frames] [threshold]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#include "scenes.h"
+
+#define FB_W 1024
+#define FB_H 1024
+
+uint8_t canvas[FB_H][FB_W], canvas_lod[FB_H][FB_W];
+uint8_t (*target)[FB_W] = canvas;
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void copy_tile(const pp_tile_t *t) {
+  for(int32_t y = 0; y < t->h; y++) {
+    memcpy(&target[t->y + y][t->x], &t->data[y * t->stride], t->w);
+  }
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+  return ua < ub ? -1 : ua > ub;
+}
+
+double median_ms(uint64_t *times, int frames) {
+  qsort(times, frames, sizeof(uint64_t), compare_u64);
+  return times[(frames - 1) / 2] / 1e6;
+}
+
+int edge_count(pp_poly_t *poly) {
+  int edges = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) edges += path->count;
+  return edges;
+}
+
+// length of the outline of `poly` transformed by `m`
+double perimeter(pp_poly_t *poly, pp_mat3_t *m) {
+  double length = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) {
+    for(int i = 0, j = path->count - 1; i < path->count; j = i++) {
+      pp_point_t a = pp_point_transform(&path->points[i], m), b = pp_point_transform(&path->points[j], m);
+      length += sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+    }
+  }
+  return length;
+}
+
+// -- shapes ----------------------------------------------------------------------
+//
+// each is drawn centred on the canvas, `fit` is the scale that fills it and
+// `flip` mirrors it vertically (the logo is in svg coordinates)
+
+typedef struct {
+  const char *name;
+  pp_poly_t *poly;
+  float fit;
+  bool flip;
+} shape_t;
+
+void shape_transform(shape_t *shape, float zoom, pp_mat3_t *m) {
+  pp_rect_t b = pp_poly_bounds(shape->poly);
+  float s = shape->fit * zoom;
+  *m = pp_mat3_identity();
+  pp_mat3_translate(m, FB_W / 2, FB_H / 2);
+  pp_mat3_scale(m, s, shape->flip ? -s : s);
+  pp_mat3_translate(m, -b.x - b.w / 2.0f, -b.y - b.h / 2.0f);
+}
+
+// draws `poly` as it is, or with its levels of detail if `lod` is given
+double draw(pp_poly_t *poly, pp_poly_lod_t *lod, uint8_t (*out)[FB_W], uint64_t *times, int frames) {
+  target = out;
+  for(int f = 0; f < frames; f++) {
+    memset(out, 0, FB_W * FB_H);
+    uint64_t start = now_ns();
+    if(lod) pp_render_lod(lod); else pp_render(poly);
+    times[f] = now_ns() - start;
+  }
+  return median_ms(times, frames);
+}
+
+// -- main ------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20;
+  if(frames < 1) frames = 1;
+  if(argc > 2) pp_lod_threshold(atof(argv[2]));
+
+  uint64_t *times = malloc(sizeof(uint64_t) * frames);
+  scene_map_init();
+  pp_poly_t *logo = scene_parse_svg(scene_logo_svg);
+  shape_t shapes[] = {
+    {"map", scene_map_poly, 0.55f, false},
+    {"logo", logo, 900.0f / pp_poly_bounds(logo).w, true}
+  };
+  const float zooms[] = {1.0f, 0.5f, 0.25f, 0.125f, 0.0625f, 0.03125f};
+
+  pp_clip(0, 0, FB_W, FB_H);
+  pp_antialias(PP_AA_X4);
+  pp_tile_callback(copy_tile);
+
+  printf("{\n");
+  printf("  \"variant\": {\"width\": %d, \"height\": %d, \"threshold\": %.3f},\n", FB_W, FB_H, _pp_lod_threshold);
+  printf("  \"results\": [");
+
+  int failures = 0;
+  for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+    pp_poly_t *poly = shapes[s].poly;
+
+    uint64_t start = now_ns();
+    pp_poly_lod_t *lod = pp_poly_lod_new(poly, 16);
+    double lod_ms = (now_ns() - start) / 1e6;
+
+    int levels = 0;
+    for(pp_lod_level_t *level = lod->levels; level; level = level->next) levels++;
+
+    for(size_t z = 0; z < sizeof(zooms) / sizeof(zooms[0]); z++) {
+      pp_mat3_t m;
+      shape_transform(&shapes[s], zooms[z], &m);
+      pp_transform(&m);
+
+      // without levels, then with
+      double original_ms = draw(poly, NULL, canvas, times, frames);
+      double lod_draw_ms = draw(poly, lod, canvas_lod, times, frames);
+
+      pp_poly_t *selected = pp_poly_lod_select(lod);
+      float error = 0.0f;
+      for(pp_lod_level_t *level = lod->levels; level; level = level->next) {
+        if(level->poly == selected) error = level->error;
+      }
+
+      // every point of the outline moves by at most the threshold
+      int differ = 0;
+      double changed = 0, allowed = perimeter(poly, &m) * _pp_lod_threshold;
+      for(int y = 0; y < FB_H; y++) {
+        for(int x = 0; x < FB_W; x++) {
+          int d = abs(canvas[y][x] - canvas_lod[y][x]);
+          if(d) differ++;
+          changed += d / 255.0;
+        }
+      }
+      if(changed > allowed) {
+        fprintf(stderr, "%s at %.4f: %.1f pixels of coverage changed, at most %.1f allowed\n",
+          shapes[s].name, zooms[z], changed, allowed);
+        failures++;
+      }
+
+      printf("%s\n    {\"shape\": \"%s\", \"zoom\": %.4f, \"levels\": %d, \"lod_ms\": %.3f, ",
+        s || z ? "," : "", shapes[s].name, zooms[z], levels, lod_ms);
+      printf("\"edges\": %d, \"edges_drawn\": %d, \"level_error\": %.3f, ",
+        edge_count(poly), edge_count(selected), error);
+      printf("\"original_ms\": %.3f, \"lod_ms_per_frame\": %.3f, \"speedup\": %.2f, ",
+        original_ms, lod_draw_ms, original_ms / lod_draw_ms);
+      printf("\"pixels_differing\": %d, \"coverage_changed\": %.1f, \"coverage_allowed\": %.1f}", differ, changed, allowed);
+      fflush(stdout);
+
+      pp_transform(NULL);
+    }
+    pp_poly_lod_free(lod);
+  }
+
+  printf("\n  ]\n}\n");
+
+  pp_poly_free(scene_map_poly);
+  pp_poly_free(logo);
+  free(times);
+  return failures ? 1 : 0;
+}
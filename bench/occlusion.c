@@ -0,0 +1,183 @@
+// pretty poly occlusion culling benchmark
+//
+// draws a desktop of overlapping opaque windows, each with translucent
+// content, over a full screen background two ways:
+//
+//   back to front - painter's order, every tile blended over the framebuffer
+//   front to back - reversed order with pp_occlusion(), opaque windows hide
+//                   what is behind them and tiles are blended under the
+//                   framebuffer (PPB_RGBA8888_UNDER)
+//
+// and reports the median frame time, tiles rasterised, tiles skipped as
+// hidden, and pixels blended of each as json on stdout. the blend arithmetic
+// differs (over vs under) so the largest difference in any channel is
+// reported, above 8 the program exits with a non-zero status
+//
+// usage: pp_bench_occlusion [frames]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_STATS
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#define PPB_IMPLEMENTATION
+#include "pretty-poly-blit.h"
+
+#define FB_W 1280
+#define FB_H 720
+
+uint32_t fb_over[FB_W * FB_H], fb_under[FB_W * FB_H];
+
+uint64_t pixels_blended;
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void count_tile(const pp_tile_t *tile) {
+  pixels_blended += tile->w * tile->h;
+  ppb_tile(tile);
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+  return ua < ub ? -1 : ua > ub;
+}
+
+double median_ms(uint64_t *times, int frames) {
+  qsort(times, frames, sizeof(uint64_t), compare_u64);
+  return times[(frames - 1) / 2] / 1e6;
+}
+
+// -- desktop -------------------------------------------------------------------
+//
+// draws in back to front order, the first is the background
+
+typedef struct {
+  pp_poly_t *poly;
+  uint32_t colour;
+} draw_t;
+
+draw_t draws[512];
+int draw_count;
+
+void add(pp_poly_t *poly, uint32_t colour) {
+  draws[draw_count++] = (draw_t){poly, colour};
+}
+
+void build_desktop(int windows) {
+  uint32_t seed = 1;
+  add(ppp_rect((ppp_rect_def){0, 0, FB_W, FB_H, 0, 0, 0, 0, 0}), 0xff402020);
+  for(int i = 0; i < windows; i++) {
+    seed = seed * 1664525u + 1013904223u; float x = (seed >> 8) % (FB_W - 400);
+    seed = seed * 1664525u + 1013904223u; float y = (seed >> 8) % (FB_H - 300);
+    add(ppp_rect((ppp_rect_def){x, y, 400, 300, 0, 8, 8, 8, 8}), 0xff000000 | (seed & 0x7f7f7f));
+    add(ppp_rect((ppp_rect_def){x, y, 400, 28, 0, 8, 8, 0, 0}), 0xff806040);
+    for(int j = 0; j < 6; j++) {
+      add(ppp_circle((ppp_circle_def){x + 50 + j * 60, y + 150 + (j & 1) * 40, 30, 0}), 0x80f0c060 + j * 0x10);
+    }
+    add(ppp_rect((ppp_rect_def){x + 20, y + 240, 360, 40, 2, 4, 4, 4, 4}), 0xc0ffffff);
+  }
+}
+
+// -- main ------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20;
+  if(frames < 1) frames = 1;
+
+  uint64_t *times = malloc(sizeof(uint64_t) * frames);
+  pp_occlusion_t *occlusion = pp_occlusion_new(FB_W, FB_H);
+  const int window_counts[] = {4, 16, 48};
+
+  pp_clip(0, 0, FB_W, FB_H);
+  pp_antialias(PP_AA_X4);
+  pp_tile_callback(count_tile);
+
+  printf("{\n");
+  printf("  \"variant\": {\"width\": %d, \"height\": %d},\n", FB_W, FB_H);
+  printf("  \"results\": [");
+
+  int failures = 0;
+  for(size_t w = 0; w < sizeof(window_counts) / sizeof(window_counts[0]); w++) {
+    draw_count = 0;
+    build_desktop(window_counts[w]);
+
+    // back to front
+    pp_stats_t over_stats = {0};
+    uint64_t over_pixels = 0;
+    for(int f = 0; f < frames; f++) {
+      pp_stats_reset();
+      pixels_blended = 0;
+      uint64_t start = now_ns();
+      for(int i = 0; i < draw_count; i++) {
+        ppb_target(&(ppb_target_t){.format = PPB_RGBA8888, .fb = fb_over, .stride = FB_W, .colour = draws[i].colour});
+        pp_render(draws[i].poly);
+      }
+      times[f] = now_ns() - start;
+      over_stats = *pp_stats();
+      over_pixels = pixels_blended;
+    }
+    double over_ms = median_ms(times, frames);
+
+    // front to back, the framebuffer starts transparent
+    pp_stats_t under_stats = {0};
+    uint64_t under_pixels = 0;
+    for(int f = 0; f < frames; f++) {
+      pp_stats_reset();
+      pixels_blended = 0;
+      uint64_t start = now_ns();
+      memset(fb_under, 0, sizeof(fb_under));
+      pp_occlusion_clear(occlusion);
+      pp_occlusion(occlusion);
+      for(int i = draw_count - 1; i >= 0; i--) {
+        pp_opaque((draws[i].colour >> 24) == 255);
+        ppb_target(&(ppb_target_t){.format = PPB_RGBA8888_UNDER, .fb = fb_under, .stride = FB_W, .colour = draws[i].colour});
+        pp_render(draws[i].poly);
+      }
+      pp_occlusion(NULL);
+      pp_opaque(false);
+      times[f] = now_ns() - start;
+      under_stats = *pp_stats();
+      under_pixels = pixels_blended;
+    }
+    double under_ms = median_ms(times, frames);
+
+    int max_error = 0;
+    for(int i = 0; i < FB_W * FB_H; i++) {
+      for(int shift = 0; shift < 24; shift += 8) {
+        int d = abs((int)((fb_over[i] >> shift) & 0xff) - (int)((fb_under[i] >> shift) & 0xff));
+        if(d > max_error) max_error = d;
+      }
+    }
+    if(max_error > 8) {
+      fprintf(stderr, "%d windows: front to back differs by %d\n", window_counts[w], max_error);
+      failures++;
+    }
+
+    printf("%s\n    {\"windows\": %d, \"draws\": %d, ", w ? "," : "", window_counts[w], draw_count);
+    printf("\"back_to_front_ms\": %.3f, \"front_to_back_ms\": %.3f, \"speedup\": %.2f, ",
+      over_ms, under_ms, over_ms / under_ms);
+    printf("\"back_to_front_tiles\": %u, \"front_to_back_tiles\": %u, \"tiles_occluded\": %u, ",
+      over_stats.tiles_visited, under_stats.tiles_visited, under_stats.tiles_occluded);
+    printf("\"back_to_front_pixels\": %llu, \"front_to_back_pixels\": %llu, \"max_error\": %d}",
+      (unsigned long long)over_pixels, (unsigned long long)under_pixels, max_error);
+    fflush(stdout);
+
+    for(int i = 0; i < draw_count; i++) pp_poly_free(draws[i].poly);
+  }
+
+  printf("\n  ]\n}\n");
+
+  pp_occlusion_free(occlusion);
+  free(times);
+  return failures ? 1 : 0;
+}
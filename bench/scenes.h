@@ -0,0 +1,331 @@
+// canonical benchmark scenes shared by the pretty poly benchmark programs
+//
+// each scene draws one frame of an animation through `scene_draw()` which the
+// including program can point at its own function (e.g. to count edges or to
+// submit draws to a different renderer). by default it calls `pp_render()`
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pretty-poly.h"
+#include "pretty-poly-primitives.h"
+
+typedef struct {
+  const char *name;
+  int32_t w, h;                // canvas size
+  void (*init)();
+  void (*frame)(int frame);    // draw frame number `frame`
+  void (*deinit)();
+} scene_t;
+
+void scene_draw_default(pp_poly_t *poly, uint32_t colour) {
+  pp_render(poly);
+}
+
+// called by scenes for every polygon they draw, colour is 0xAABBGGRR
+void (*scene_draw)(pp_poly_t *poly, uint32_t colour) = scene_draw_default;
+
+// small deterministic random number generator so every run (and every 
+// variant) draws exactly the same geometry
+uint32_t scene_seed = 1;
+uint32_t scene_rand() {
+  scene_seed = scene_seed * 1664525u + 1013904223u;
+  return scene_seed >> 8;
+}
+float scene_randf() { return (float)scene_rand() / (float)(1 << 24); }
+
+uint32_t scene_hsv(float h, float a) {
+  float r = fabsf(h * 6.0f - 3.0f) - 1.0f;
+  float g = 2.0f - fabsf(h * 6.0f - 2.0f);
+  float b = 2.0f - fabsf(h * 6.0f - 4.0f);
+  r = r < 0 ? 0 : r > 1 ? 1 : r;
+  g = g < 0 ? 0 : g > 1 ? 1 : g;
+  b = b < 0 ? 0 : b > 1 ? 1 : b;
+  return (uint32_t)(r * 255) | ((uint32_t)(g * 255) << 8) | ((uint32_t)(b * 255) << 16) | ((uint32_t)(a * 255) << 24);
+}
+
+// -- logo: the pretty poly logo (one polygon, eleven contours) rotating ------
+
+const char *scene_logo_svg = 
+  "M3260 3933 c-168 -179 -274 -287 -503 -520 -248 -253 -248 -253 -1442 -253 "
+  "-657 0 -1195 -3 -1195 -6 0 -9 124 -189 132 -192 5 -2 8 -9 8 -15 0 -6 9 "
+  "-20 19 -31 11 -12 27 -35 38 -53 10 -18 31 -50 47 -73 29 -41 29 -41 -59 "
+  "-173 -49 -73 -93 -133 -97 -135 -4 -2 -8 -9 -8 -14 0 -6 -17 -34 -38 -62 "
+  "-21 -28 -42 -57 -46 -64 -6 -10 154 -12 805 -12 446 0 814 -1 816 -4 2 -2 "
+  "-9 -23 -25 -47 -34 -51 -104 -188 -122 -239 -7 -19 -16 -44 -20 -55 -53 "
+  "-128 -67 -261 -69 -641 -1 -117 -4 -164 -13 -171 -7 -6 -31 -13 -53 -16 "
+  "-22 -3 -47 -8 -56 -12 -19 -7 -32 20 -50 110 -7 33 -13 61 -15 63 -6 8 -85 "
+  "-51 -115 -86 -83 -97 -98 -161 -80 -347 20 -205 30 -241 83 -294 45 -46 99 "
+  "-67 205 -80 126 -15 263 -65 396 -145 35 -20 113 -100 158 -161 24 -33 49 "
+  "-66 56 -72 6 -7 13 -18 15 -24 3 -9 10 -9 27 0 12 7 20 19 17 26 -2 7 1 16 "
+  "9 18 7 3 28 36 46 74 30 63 32 76 32 168 0 55 -4 111 -10 125 -6 14 -10 27 "
+  "-9 30 0 3 -12 27 -28 54 -28 48 -28 48 11 90 82 86 150 228 169 351 6 43 "
+  "17 61 78 130 39 44 73 82 76 85 43 43 192 269 185 280 -3 6 -2 10 4 10 27 "
+  "0 190 372 210 480 5 30 13 87 17 125 4 39 8 75 9 80 1 6 3 30 3 55 2 45 2 "
+  "45 734 43 403 -2 729 0 723 5 -5 4 -14 15 -20 24 -5 9 -65 98 -132 197 -68 "
+  "99 -123 186 -123 192 0 7 6 20 14 28 8 9 69 97 135 196 122 180 122 180 "
+  "-494 183 -564 2 -640 5 -606 26 4 3 11 23 15 44 3 21 13 61 21 88 8 27 31 "
+  "108 51 179 20 72 45 162 55 200 11 39 28 102 39 140 10 39 23 87 30 108 6 "
+  "21 10 43 8 48 -2 6 -32 -20 -68 -58z m-2188 -993 c-3 -149 1 -152 43 -24 "
+  "14 43 35 98 46 122 20 43 35 50 87 36 19 -6 22 -11 17 -35 -4 -15 -15 -46 "
+  "-26 -68 -10 -22 -19 -46 -19 -54 0 -7 -4 -17 -9 -23 -5 -5 -16 -29 -24 -54 "
+  "-15 -45 -15 -45 18 -82 40 -43 51 -98 41 -195 -12 -112 -50 -143 -177 -143 "
+  "-43 0 -81 5 -84 10 -8 13 -14 476 -7 578 5 73 5 73 51 70 46 -3 46 -3 43 "
+  "-138z m476 107 c2 -10 1 -29 -2 -43 -6 -22 -11 -24 -70 -24 -63 0 -64 0 "
+  "-70 -31 -3 -17 -6 -62 -6 -100 0 -69 0 -69 56 -69 55 0 55 0 52 -42 -3 -43 "
+  "-3 -43 -55 -46 -53 -3 -53 -3 -53 -93 0 -89 0 -89 70 -89 70 0 70 0 70 -39 "
+  "0 -48 -4 -50 -127 -50 -69 0 -94 4 -104 15 -9 11 -10 51 -5 162 4 81 7 187 "
+  "6 236 -2 135 9 234 27 238 8 2 59 1 112 -2 83 -4 96 -8 99 -23z m820 21 c8 "
+  "-8 12 -53 12 -132 1 -104 12 -189 33 -246 4 -8 8 -28 11 -45 15 -90 19 "
+  "-111 26 -120 5 -5 10 -30 12 -55 3 -44 3 -45 -30 -48 -44 -4 -59 10 -67 61 "
+  "-3 23 -10 60 -15 82 -5 22 -12 62 -15 89 -8 59 -21 50 -34 -24 -14 -80 -39 "
+  "-189 -46 -200 -8 -14 -58 -13 -72 1 -12 12 -9 56 7 94 4 11 15 52 25 90 9 "
+  "39 26 106 37 150 13 48 23 122 25 185 2 58 6 111 8 118 6 15 67 16 83 0z "
+  "m869 -32 c43 -46 47 -85 36 -334 -8 -192 -11 -211 -31 -240 -43 -59 -157 "
+  "-65 -212 -11 -37 37 -43 100 -36 357 6 182 7 195 28 222 30 36 71 50 133 "
+  "45 41 -4 56 -10 82 -39z m485 -86 c3 -75 15 -159 28 -210 12 -47 26 -105 "
+  "31 -130 5 -25 14 -65 20 -90 20 -85 18 -95 -19 -98 -41 -4 -62 12 -62 48 0 "
+  "15 -6 45 -13 66 -7 22 -13 44 -13 49 0 6 -4 39 -9 75 -8 65 -8 65 -25 -5 "
+  "-10 -38 -23 -101 -31 -140 -7 -38 -19 -76 -25 -82 -16 -17 -59 -17 -72 0 "
+  "-11 13 -8 31 48 242 23 85 34 156 40 245 10 156 12 162 59 158 36 -3 36 -3 "
+  "43 -128z m-2979 78 c3 -24 4 -82 3 -129 -3 -87 -3 -87 43 -92 106 -13 134 "
+  "-53 135 -195 0 -93 -16 -142 -54 -162 -28 -15 -193 -30 -205 -19 -6 6 -11 "
+  "132 -13 324 -4 315 -4 315 41 315 45 0 45 0 50 -42z m1007 -238 c0 -280 0 "
+  "-280 46 -280 45 0 45 0 42 -42 -3 -43 -3 -43 -121 -46 -140 -3 -157 3 -157 "
+  "58 0 40 0 40 45 40 45 0 45 0 46 68 1 37 3 123 5 192 2 69 3 162 4 208 0 "
+  "82 0 82 45 82 45 0 45 0 45 -280z m312 3 c3 -278 3 -278 46 -281 43 -3 43 "
+  "-3 40 -45 -3 -42 -3 -42 -118 -45 -134 -3 -170 7 -170 47 0 37 17 51 62 51 "
+  "43 0 40 -26 39 305 -1 77 2 164 5 193 6 52 6 52 50 52 44 0 44 0 46 -277z "
+  "m698 148 c0 -128 0 -128 58 -134 50 -5 61 -10 89 -42 24 -28 33 -50 39 -92 "
+  "16 -130 -14 -214 -84 -232 -40 -11 -168 -18 -175 -11 -8 8 -18 626 -11 633 "
+  "4 4 25 7 46 7 38 0 38 0 38 -129z m815 84 c0 -40 0 -40 -66 -43 -66 -3 -66 "
+  "-3 -72 -160 -3 -86 -6 -208 -7 -271 0 -63 -3 -118 -6 -123 -3 -4 -23 -8 "
+  "-45 -8 -39 0 -39 0 -39 325 0 326 0 326 118 323 117 -3 117 -3 117 -43z";
+
+pp_poly_t *scene_logo_poly;
+pp_rect_t scene_logo_bounds;
+
+pp_point_t scene_bezier(float t, pp_point_t s, pp_point_t c1, pp_point_t c2, pp_point_t e) {
+  float u = 1.0f - t;
+  float a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+  return (pp_point_t){
+    .x = a * s.x + b * c1.x + c * c2.x + d * e.x,
+    .y = a * s.y + b * c1.y + c * c2.y + d * e.y
+  };
+}
+
+// parses the small subset of svg path syntax used by the logo (M, m, c, z)
+// and flattens each curve into four line segments
+pp_poly_t *scene_parse_svg(const char *svg) {
+  pp_poly_t *poly = pp_poly_new();
+  pp_path_t *path = NULL;
+  char command = 0;
+  float cx = 0, cy = 0, sx = 0, sy = 0;
+  const char *p = svg;
+  while(*p) {
+    while(*p == ' ' || *p == '\n') p++;
+    if(!*p) break;
+
+    if(strchr("MmCcZz", *p)) {
+      command = *p++;
+      if(command == 'z' || command == 'Z') { cx = sx; cy = sy; path = NULL; }
+      continue;
+    }
+
+    float v[6]; int n = (command == 'c' || command == 'C') ? 6 : 2;
+    for(int i = 0; i < n; i++) {
+      char *end; v[i] = strtof(p, &end); p = end;
+    }
+
+    bool relative = command == 'm' || command == 'c';
+    if(relative) for(int i = 0; i < n; i += 2) { v[i] += cx; v[i + 1] += cy; }
+
+    if(command == 'M' || command == 'm') {
+      if(!path) { path = pp_poly_add_path(poly); sx = v[0]; sy = v[1]; }
+      pp_path_add_point(path, (pp_point_t){v[0], v[1]});
+      command = relative ? 'l' : 'L'; // further pairs are implicit lines
+    } else if(command == 'l' || command == 'L') {
+      pp_path_add_point(path, (pp_point_t){v[0], v[1]});
+    } else {
+      pp_point_t s = {cx, cy}, c1 = {v[0], v[1]}, c2 = {v[2], v[3]}, e = {v[4], v[5]};
+      for(int i = 1; i <= 4; i++) pp_path_add_point(path, scene_bezier(i / 4.0f, s, c1, c2, e));
+    }
+    cx = v[n - 2]; cy = v[n - 1];
+  }
+  return poly;
+}
+
+void scene_logo_init() {
+  scene_logo_poly = scene_parse_svg(scene_logo_svg);
+  scene_logo_bounds = pp_polygon_bounds(scene_logo_poly);
+}
+
+void scene_logo_frame(int frame) {
+  float scale = 900.0f / (float)scene_logo_bounds.w;
+  pp_mat3_t t = pp_mat3_identity();
+  pp_mat3_translate(&t, 512, 512);
+  pp_mat3_rotate(&t, frame * 3.0f);
+  pp_mat3_scale(&t, scale, -scale);
+  pp_mat3_translate(&t, -scene_logo_bounds.x - scene_logo_bounds.w / 2, -scene_logo_bounds.y - scene_logo_bounds.h / 2);
+  pp_transform(&t);
+  scene_draw(scene_logo_poly, 0xffa3b2ea);
+  pp_transform(NULL);
+}
+
+void scene_logo_deinit() {
+  pp_poly_free(scene_logo_poly);
+}
+
+// -- text: a page of small ampersand glyphs (Alright Fonts outline) ----------
+
+pp_point_t scene_amp_outline[] = {
+  {16, 61}, {14, 59}, {12, 56}, {11, 53}, {10, 50}, {9, 45}, {9, 41}, {12, 36}, {16, 32}, {20, 28},
+  {31, 24}, {35, 25}, {39, 28}, {43, 31}, {46, 35}, {50, 42}, {48, 49}, {40, 59}, {36, 62}, {47, 75},
+  {48, 71}, {50, 63}, {64, 63}, {63, 73}, {57, 87}, {69, 100}, {50, 100}, {46, 96}, {43, 98}, {40, 99},
+  {37, 100}, {33, 100}, {27, 101}, {21, 100}, {15, 98}, {10, 94}, {6, 90}, {3, 80}, {3, 78}, {4, 74},
+  {6, 71}, {9, 68}, {16, 61}
+};
+pp_point_t scene_amp_hole1[] = {
+  {24, 44}, {24, 47}, {28, 53}, {32, 51}, {33, 49}, {34, 48}, {35, 47}, {36, 44}, {35, 43}, {35, 42},
+  {34, 40}, {32, 39}, {30, 38}, {28, 39}, {27, 39}, {26, 40}, {25, 42}
+};
+pp_point_t scene_amp_hole2[] = {
+  {28, 88}, {31, 88}, {37, 86}, {24, 70}, {23, 71}, {21, 74}, {20, 79}, {20, 82}, {21, 84}, {22, 85},
+  {24, 87}
+};
+pp_path_t scene_amp_paths[3];
+pp_poly_t scene_amp = {.paths = scene_amp_paths};
+
+void scene_text_init() {
+  scene_amp_paths[0] = (pp_path_t){.points = scene_amp_outline, .count = 43, .next = &scene_amp_paths[1]};
+  scene_amp_paths[1] = (pp_path_t){.points = scene_amp_hole1, .count = 17, .next = &scene_amp_paths[2]};
+  scene_amp_paths[2] = (pp_path_t){.points = scene_amp_hole2, .count = 11};
+}
+
+void scene_text_frame(int frame) {
+  // 64 columns by 51 lines of 16px glyphs that drift by a fraction of a pixel
+  // each frame so sub-pixel positions are exercised
+  float drift = (frame % 8) / 8.0f;
+  for(int line = 0; line < 51; line++) {
+    for(int col = 0; col < 64; col++) {
+      pp_mat3_t t = pp_mat3_identity();
+      pp_mat3_translate(&t, col * 16 + drift, line * 20 + drift);
+      pp_mat3_scale(&t, 0.25f, 0.25f);
+      pp_transform(&t);
+      scene_draw(&scene_amp, 0xffffffff);
+    }
+  }
+  pp_transform(NULL);
+}
+
+void scene_text_deinit() {}
+
+// -- primitives: a grid of rotating primitive shapes, filled and stroked ----
+
+pp_poly_t *scene_prims[10];
+
+void scene_prims_init() {
+  PP_COORD_TYPE s = 80, t = 16;
+  scene_prims[0] = ppp_rect((ppp_rect_def){-s, -s, s * 2, s * 2});
+  scene_prims[1] = ppp_rect((ppp_rect_def){-s, -s, s * 2, s * 2, t});
+  scene_prims[2] = ppp_circle((ppp_circle_def){0, 0, s});
+  scene_prims[3] = ppp_circle((ppp_circle_def){0, 0, s, t});
+  scene_prims[4] = ppp_regular((ppp_regular_def){0, 0, s, 5});
+  scene_prims[5] = ppp_regular((ppp_regular_def){0, 0, s, 6, t});
+  scene_prims[6] = ppp_star((ppp_star_def){0, 0, 7, s, s * 3 / 4});
+  scene_prims[7] = ppp_star((ppp_star_def){0, 0, 7, s, s * 3 / 4, t});
+  scene_prims[8] = ppp_rect((ppp_rect_def){-s, -s, s * 2, s * 2, 0, s / 2, s / 8, s / 4, s * 3 / 4});
+  scene_prims[9] = ppp_arc((ppp_arc_def){0, 0, s, t, 30, 290});
+}
+
+void scene_prims_frame(int frame) {
+  for(int y = 0; y < 5; y++) {
+    for(int x = 0; x < 5; x++) {
+      int i = x + y * 5;
+      pp_mat3_t t = pp_mat3_identity();
+      pp_mat3_translate(&t, 102 + x * 205, 102 + y * 205);
+      pp_mat3_rotate(&t, frame * 2.0f + i * 15.0f);
+      pp_transform(&t);
+      scene_draw(scene_prims[i % 10], scene_hsv(i / 25.0f, 0.8f));
+    }
+  }
+  pp_transform(NULL);
+}
+
+void scene_prims_deinit() {
+  for(int i = 0; i < 10; i++) pp_poly_free(scene_prims[i]);
+}
+
+// -- tiny: 10,000 polygons only a few pixels across -------------------------
+
+pp_poly_t *scene_tiny_polys[3];
+
+void scene_tiny_init() {
+  scene_tiny_polys[0] = ppp_regular((ppp_regular_def){0, 0, 3, 3});
+  scene_tiny_polys[1] = ppp_star((ppp_star_def){0, 0, 5, 4, 2});
+  scene_tiny_polys[2] = ppp_rect((ppp_rect_def){-2, -2, 4, 4});
+}
+
+void scene_tiny_frame(int frame) {
+  scene_seed = frame + 1;
+  for(int i = 0; i < 10000; i++) {
+    pp_mat3_t t = pp_mat3_identity();
+    pp_mat3_translate(&t, scene_randf() * 1024, scene_randf() * 1024);
+    pp_mat3_rotate(&t, scene_randf() * 360);
+    pp_transform(&t);
+    scene_draw(scene_tiny_polys[i % 3], scene_hsv(i / 10000.0f, 1.0f));
+  }
+  pp_transform(NULL);
+}
+
+void scene_tiny_deinit() {
+  for(int i = 0; i < 3; i++) pp_poly_free(scene_tiny_polys[i]);
+}
+
+// -- map: a huge coastline polygon (5,000 vertices) with lakes -------------
+
+pp_poly_t *scene_map_poly;
+
+void scene_map_path(pp_path_t *path, float cx, float cy, float r, int count, float roughness, int clockwise) {
+  for(int i = 0; i < count; i++) {
+    float a = (float)(clockwise ? i : count - i) / (float)count * (float)M_PI * 2.0f;
+    float d = r * (1.0f + roughness * (0.3f * sinf(a * 7) + 0.2f * sinf(a * 31) + 0.1f * sinf(a * 97) + 0.05f * (scene_randf() - 0.5f)));
+    pp_path_add_point(path, (pp_point_t){cx + cosf(a) * d, cy + sinf(a) * d});
+  }
+}
+
+void scene_map_init() {
+  scene_seed = 1234;
+  scene_map_poly = pp_poly_new();
+  scene_map_path(pp_poly_add_path(scene_map_poly), 0, 0, 900, 5000, 0.5f, 1);
+  for(int i = 0; i < 12; i++) {
+    float a = i * 0.52f, d = 150 + i * 40;
+    scene_map_path(pp_poly_add_path(scene_map_poly), cosf(a) * d, sinf(a) * d, 40 + i * 5, 200, 0.4f, 0);
+  }
+}
+
+void scene_map_frame(int frame) {
+  pp_mat3_t t = pp_mat3_identity();
+  pp_mat3_translate(&t, 512, 512);
+  pp_mat3_rotate(&t, frame * 0.5f);
+  pp_mat3_scale(&t, 0.8f + (frame % 10) * 0.02f, 0.8f + (frame % 10) * 0.02f);
+  pp_transform(&t);
+  scene_draw(scene_map_poly, 0xff60a040);
+  pp_transform(NULL);
+}
+
+void scene_map_deinit() {
+  pp_poly_free(scene_map_poly);
+}
+
+scene_t scenes[] = {
+  {"logo",       1024, 1024, scene_logo_init,  scene_logo_frame,  scene_logo_deinit},
+  {"text",       1024, 1024, scene_text_init,  scene_text_frame,  scene_text_deinit},
+  {"primitives", 1024, 1024, scene_prims_init, scene_prims_frame, scene_prims_deinit},
+  {"tiny",       1024, 1024, scene_tiny_init,  scene_tiny_frame,  scene_tiny_deinit},
+  {"map",        1024, 1024, scene_map_init,   scene_map_frame,   scene_map_deinit}
+};
+const int scene_count = sizeof(scenes) / sizeof(scenes[0]);
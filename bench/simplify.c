@@ -0,0 +1,194 @@
+// pretty poly simplification benchmark
+//
+// draws three shapes at full size and zoomed out by 4 and 16 times:
+//
+//   logo     - the pretty poly logo, flattened svg curves
+//   map      - the 5,000 vertex coastline with lakes from the map scene
+//   circles  - a grid of 64 circles, each with one edge per pixel of radius
+//
+// and simplifies each with pp_poly_simplify() for the transform it is drawn
+// with, as an app would once per zoom level. reports how long that takes, the
+// edge count before and after, the median time to draw the original and the
+// simplified polygon, and how many pixels differ as json on stdout. the
+// coverage that changes (in pixels) must be less than the tolerance times the
+// length of the outline on screen, otherwise the program exits with a
+// non-zero status
+//
+// usage: pp_bench_simplify [frames] [tolerance]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#include "scenes.h"
+
+#define FB_W 1024
+#define FB_H 1024
+
+uint8_t canvas[FB_H][FB_W], canvas_simple[FB_H][FB_W];
+uint8_t (*target)[FB_W] = canvas;
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void copy_tile(const pp_tile_t *t) {
+  for(int32_t y = 0; y < t->h; y++) {
+    memcpy(&target[t->y + y][t->x], &t->data[y * t->stride], t->w);
+  }
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+  return ua < ub ? -1 : ua > ub;
+}
+
+double median_ms(uint64_t *times, int frames) {
+  qsort(times, frames, sizeof(uint64_t), compare_u64);
+  return times[(frames - 1) / 2] / 1e6;
+}
+
+int edge_count(pp_poly_t *poly) {
+  int edges = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) edges += path->count;
+  return edges;
+}
+
+// length of the outline of `poly` transformed by `m`
+double perimeter(pp_poly_t *poly, pp_mat3_t *m) {
+  double length = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) {
+    for(int i = 0, j = path->count - 1; i < path->count; j = i++) {
+      pp_point_t a = pp_point_transform(&path->points[i], m), b = pp_point_transform(&path->points[j], m);
+      length += sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+    }
+  }
+  return length;
+}
+
+// -- shapes ----------------------------------------------------------------------
+//
+// each is built once and drawn centred on the canvas, `fit` is the scale that
+// fills it and `flip` mirrors it vertically (the logo is in svg coordinates)
+
+typedef struct {
+  const char *name;
+  pp_poly_t *poly;
+  float fit;
+  bool flip;
+} shape_t;
+
+shape_t build_logo() {
+  pp_poly_t *poly = scene_parse_svg(scene_logo_svg);
+  return (shape_t){"logo", poly, 900.0f / pp_poly_bounds(poly).w, true};
+}
+
+shape_t build_map() {
+  scene_map_init();
+  return (shape_t){"map", scene_map_poly, 0.55f, false};
+}
+
+shape_t build_circles() {
+  pp_poly_t *poly = pp_poly_new();
+  for(int y = 0; y < 8; y++) {
+    for(int x = 0; x < 8; x++) {
+      pp_poly_merge(poly, ppp_circle((ppp_circle_def){x * 128 + 64, y * 128 + 64, 60, 0}));
+    }
+  }
+  return (shape_t){"circles", poly, 1.0f, false};
+}
+
+void shape_transform(shape_t *shape, float zoom, pp_mat3_t *m) {
+  pp_rect_t b = pp_poly_bounds(shape->poly);
+  float s = shape->fit * zoom;
+  *m = pp_mat3_identity();
+  pp_mat3_translate(m, FB_W / 2, FB_H / 2);
+  pp_mat3_scale(m, s, shape->flip ? -s : s);
+  pp_mat3_translate(m, -b.x - b.w / 2.0f, -b.y - b.h / 2.0f);
+}
+
+double draw(pp_poly_t *poly, uint8_t (*out)[FB_W], uint64_t *times, int frames) {
+  target = out;
+  for(int f = 0; f < frames; f++) {
+    memset(out, 0, FB_W * FB_H);
+    uint64_t start = now_ns();
+    pp_render(poly);
+    times[f] = now_ns() - start;
+  }
+  return median_ms(times, frames);
+}
+
+// -- main ------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 20;
+  if(frames < 1) frames = 1;
+  float tolerance = argc > 2 ? atof(argv[2]) : 0.25f;
+
+  uint64_t *times = malloc(sizeof(uint64_t) * frames);
+  shape_t shapes[] = {build_logo(), build_map(), build_circles()};
+  const float zooms[] = {1.0f, 0.25f, 0.0625f};
+
+  pp_clip(0, 0, FB_W, FB_H);
+  pp_antialias(PP_AA_X4);
+  pp_tile_callback(copy_tile);
+
+  printf("{\n");
+  printf("  \"variant\": {\"width\": %d, \"height\": %d, \"tolerance\": %.3f},\n", FB_W, FB_H, tolerance);
+  printf("  \"results\": [");
+
+  int failures = 0;
+  for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+    for(size_t z = 0; z < sizeof(zooms) / sizeof(zooms[0]); z++) {
+      pp_mat3_t m;
+      shape_transform(&shapes[s], zooms[z], &m);
+      pp_transform(&m);
+
+      uint64_t start = now_ns();
+      pp_poly_t *simple = pp_poly_simplify(shapes[s].poly, tolerance);
+      double simplify_ms = (now_ns() - start) / 1e6;
+
+      double original_ms = draw(shapes[s].poly, canvas, times, frames);
+      double simple_ms = draw(simple, canvas_simple, times, frames);
+
+      // every point of the outline moves by at most the tolerance
+      int differ = 0;
+      double changed = 0, allowed = perimeter(shapes[s].poly, &m) * tolerance;
+      for(int y = 0; y < FB_H; y++) {
+        for(int x = 0; x < FB_W; x++) {
+          int d = abs(canvas[y][x] - canvas_simple[y][x]);
+          if(d) differ++;
+          changed += d / 255.0;
+        }
+      }
+      if(changed > allowed) {
+        fprintf(stderr, "%s at %.4f: %.1f pixels of coverage changed, at most %.1f allowed\n",
+          shapes[s].name, zooms[z], changed, allowed);
+        failures++;
+      }
+
+      printf("%s\n    {\"shape\": \"%s\", \"zoom\": %.4f, \"edges_before\": %d, \"edges_after\": %d, ",
+        s || z ? "," : "", shapes[s].name, zooms[z], edge_count(shapes[s].poly), edge_count(simple));
+      printf("\"simplify_ms\": %.3f, \"original_ms\": %.3f, \"simplified_ms\": %.3f, ", simplify_ms, original_ms, simple_ms);
+      printf("\"pixels_differing\": %d, \"coverage_changed\": %.1f, \"coverage_allowed\": %.1f}", differ, changed, allowed);
+      fflush(stdout);
+
+      pp_poly_free(simple);
+      pp_transform(NULL);
+    }
+  }
+
+  printf("\n  ]\n}\n");
+
+  for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) pp_poly_free(shapes[s].poly);
+  free(times);
+  return failures ? 1 : 0;
+}
@@ -2,3 +2,4 @@
 
 cmake -S . -B build
 cmake --build build -j
+ctest --test-dir build --output-on-failure
@@ -0,0 +1,81 @@
+// renders a scene for an imaginary 320x240 RGB565 SPI display without a
+// framebuffer, two rows at a time. each band is "sent to the display" by
+// converting it into the output image
+#include "float.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#define PPB_IMPLEMENTATION
+#include "pretty-poly-blit.h"
+#define PPS_IMPLEMENTATION
+#include "pretty-poly-scene.h"
+#include "helpers.h"
+
+#define WIDTH 320
+#define HEIGHT 240
+#define BAND_HEIGHT 2
+
+// the only pixel memory needed: one band and a tile buffer of the same size
+uint16_t band[WIDTH * BAND_HEIGHT];
+uint8_t band_tiles[WIDTH * BAND_HEIGHT];
+
+// stands in for the display
+colour display[HEIGHT][WIDTH];
+
+void flush(int32_t y, int32_t h, const void *pixels, void *data) {
+  const uint16_t *p = pixels;
+  for(int32_t row = 0; row < h; row++) {
+    for(int32_t x = 0; x < WIDTH; x++) {
+      uint16_t c = *p++;
+      display[y + row][x] = create_colour((c >> 11) << 3, ((c >> 5) & 0x3f) << 2, (c & 0x1f) << 3, 255);
+    }
+  }
+}
+
+int main() {
+  pp_tile_buffer(band_tiles, WIDTH, BAND_HEIGHT);
+  pp_clip(0, 0, WIDTH, HEIGHT);
+  pp_antialias(PP_AA_X4);
+
+  pps_scene_t *scene = pps_scene_new();
+
+  // a grid of rounded rectangles with a ring and a star over the top
+  pp_poly_t *polys[32];
+  int count = 0;
+  for(int y = 0; y < 4; y++) {
+    for(int x = 0; x < 5; x++) {
+      ppp_rect_def r = {10 + x * 62, 10 + y * 56, 52, 46, 0, 8, 8, 8, 8};
+      polys[count] = ppp_rect(r);
+      pps_add(scene, polys[count++], create_colour_hsv((x + y * 5) / 20.0f, 0.6f, 0.9f, 1.0f).c);
+    }
+  }
+
+  polys[count] = ppp_circle((ppp_circle_def){160, 120, 90, 12});
+  pps_add(scene, polys[count++], create_colour(255, 255, 255, 200).c);
+
+  pp_mat3_t m = pp_mat3_identity();
+  pp_mat3_translate(&m, 160, 120);
+  pp_mat3_rotate(&m, 15);
+  pp_transform(&m);
+  polys[count] = ppp_star((ppp_star_def){0, 0, 5, 60, 28});
+  pps_add(scene, polys[count++], create_colour(20, 20, 40, 230).c);
+  pp_transform(NULL);
+
+  pps_target_t target = {
+    .format = PPB_RGB565, .w = WIDTH, .h = HEIGHT, .band_h = BAND_HEIGHT,
+    .buffer = band, .background = create_colour(16, 32, 48, 255).c
+  };
+  pps_render(scene, &target, flush, NULL);
+
+  stbi_write_png("/tmp/out.png", WIDTH, HEIGHT, 4, (void *)display, WIDTH * sizeof(uint32_t));
+
+  pps_scene_free(scene);
+  for(int i = 0; i < count; i++) pp_poly_free(polys[i]);
+
+  return 0;
+}
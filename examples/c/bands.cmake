@@ -0,0 +1,6 @@
+add_executable(
+  bands
+  bands.c
+)
+
+target_link_libraries(bands m)
@@ -0,0 +1,117 @@
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#include "helpers.h"
+
+const int WIDTH = 320;
+const int HEIGHT = 240;
+colour buffer[240][320];
+colour background;
+
+colour pen;
+void set_pen(colour c) {
+  pen = c;
+}
+
+uint64_t pixels_drawn = 0;
+
+void blend_tile(const pp_tile_t *t) {
+  pixels_drawn += t->w * t->h;
+  for(int32_t y = t->y; y < t->y + t->h; y++) {
+    for(int32_t x = t->x; x < t->x + t->w; x++) {
+      colour alpha_pen = pen;
+      alpha_pen.a = alpha(pen.a, pp_tile_get(t, x, y));
+      buffer[y][x] = blend(buffer[y][x], alpha_pen);
+    }
+  }
+}
+
+pp_poly_t *face, *ticks, *needle;
+
+// draw the whole gauge, anything outside of the clip region is skipped
+void draw_gauge(pp_mat3_t *needle_transform) {
+  set_pen(create_colour(40, 44, 52, 255));
+  pp_render(face);
+  set_pen(create_colour(200, 200, 210, 255));
+  pp_render(ticks);
+  pp_transform(needle_transform);
+  set_pen(create_colour(240, 80, 60, 255));
+  pp_render(needle);
+  pp_transform(NULL);
+}
+
+pp_mat3_t needle_at(float value) {
+  pp_mat3_t m = pp_mat3_identity();
+  pp_mat3_translate(&m, 160, 120);
+  pp_mat3_rotate(&m, -135 + value * 270);
+  return m;
+}
+
+// animates the needle of a gauge for 60 frames, each frame only the area the
+// needle moved from and to is cleared and redrawn
+int main() {
+  pp_tile_callback(blend_tile);
+  pp_antialias(PP_AA_X4);
+  pp_clip(0, 0, WIDTH, HEIGHT);
+
+  face = ppp_circle((ppp_circle_def){160, 120, 100});
+  ticks = pp_poly_new();
+  for(int i = 0; i <= 10; i++) {
+    pp_mat3_t m = needle_at(i / 10.0f);
+    pp_point_t a = {0, -90}, b = {0, i % 5 ? -80 : -72};
+    a = pp_point_transform(&a, &m);
+    b = pp_point_transform(&b, &m);
+    pp_poly_t *tick = ppp_line((ppp_line_def){a.x, a.y, b.x, b.y, 2});
+    pp_poly_merge(ticks, tick);
+  }
+  needle = ppp_rect((ppp_rect_def){-3, -70, 6, 80, 0, 3, 3, 3, 3});
+
+  // first frame is drawn in full
+  background = create_colour(16, 16, 20, 255);
+  for(int y = 0; y < HEIGHT; y++) {
+    for(int x = 0; x < WIDTH; x++) buffer[y][x] = background;
+  }
+  pp_mat3_t last = needle_at(0.0f);
+  draw_gauge(&last);
+  uint64_t full = pixels_drawn;
+  pixels_drawn = 0;
+
+  pp_region_t *damage = pp_region_new();
+  for(int frame = 1; frame <= 60; frame++) {
+    pp_mat3_t next = needle_at(0.5f + sinf(frame * 0.1f) * 0.4f);
+
+    // everything under the needle's old and new position needs redrawing
+    pp_region_clear(damage);
+    pp_region_add_damage(damage, needle, &last, &next);
+
+    for(int i = 0; i < damage->count; i++) {
+      pp_rect_t r = damage->rects[i];
+      r = pp_rect_intersection(&r, &_pp_clip);
+      for(int y = r.y; y < r.y + r.h; y++) {
+        for(int x = r.x; x < r.x + r.w; x++) buffer[y][x] = background;
+      }
+    }
+
+    pp_clip_region(damage);
+    draw_gauge(&next);
+    pp_clip_region(NULL);
+
+    last = next;
+  }
+  pp_region_free(damage);
+
+  printf("each frame blended %llu pixels on average, a full redraw blends %llu\n",
+    (unsigned long long)(pixels_drawn / 60), (unsigned long long)full);
+
+  pp_poly_free(face);
+  pp_poly_free(ticks);
+  pp_poly_free(needle);
+
+  stbi_write_png("/tmp/out.png", WIDTH, HEIGHT, 4, (void *)buffer, WIDTH * sizeof(uint32_t));
+
+  return 0;
+}
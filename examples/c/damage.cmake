@@ -0,0 +1,6 @@
+add_executable(
+  damage
+  damage.c
+)
+
+target_link_libraries(damage m)
@@ -61,6 +61,15 @@ pp_poly_t* gear(PP_COORD_TYPE x, PP_COORD_TYPE y, int c, PP_COORD_TYPE or, PP_CO
 }
 
 
+// combine two polygons with a boolean operation, freeing both
+pp_poly_t* combine(pp_poly_t *a, pp_poly_t *b, pp_boolean_t op) {
+  pp_poly_t *result = pp_poly_boolean(a, b, op);
+  pp_poly_free(a);
+  pp_poly_free(b);
+  return result;
+}
+
+
 int main() { 
   pp_tile_callback(blend_tile);
   pp_antialias(PP_AA_X16);
@@ -134,21 +143,21 @@ int main() {
           }
         }break;
         case 13: {
-          ppp_line_def r = {-size, 0, size, 0, thickness};
-          poly = ppp_line(r);        
-          pp_poly_merge(poly, ppp_line((ppp_line_def){0, -size, 0, size, thickness}));
-          pp_poly_merge(poly, ppp_line((ppp_line_def){-size * .7, -size * .7, size * .7, size * .7, thickness}));
-          pp_poly_merge(poly, ppp_line((ppp_line_def){size * .7, -size * .7, -size * .7, size * .7, thickness}));
+          // overlapping lines unioned into one outline, merged they would
+          // leave even-odd holes where they cross
+          poly = ppp_line((ppp_line_def){-size, 0, size, 0, thickness});
+          poly = combine(poly, ppp_line((ppp_line_def){0, -size, 0, size, thickness}), PP_UNION);
+          poly = combine(poly, ppp_line((ppp_line_def){-size * .7, -size * .7, size * .7, size * .7, thickness}), PP_UNION);
+          poly = combine(poly, ppp_line((ppp_line_def){size * .7, -size * .7, -size * .7, size * .7, thickness}), PP_UNION);
         }break;        
         case 14: {
-          // poly = f_rrect(-size, -size, size * 2, size * 2, size * .5, size * .05, size * .15, size * .7);
-          // pp_poly_t *merge = gear(0, 0, 10, size * .8, size * .6, thickness);
-          // pp_poly_merge(poly, merge);
+          ppp_rect_def r = {-size, -size, size * 2, size * 2, 0, size * .5, size * .05, size * .15, size * .7};
+          poly = combine(ppp_rect(r), gear(0, 0, 10, size * .8, size * .6, thickness), PP_DIFFERENCE);
         }break;
         case 15: {
-          /*poly = star(0, 0, 7, size * 0.95, size * .75, thickness);
-          pp_poly_t *merge = circ(0, 0, size, thickness);        
-          pp_poly_merge(poly, merge);*/
+          ppp_star_def s = {0, 0, 7, size * 0.95, size * .75, thickness};
+          ppp_circle_def c = {0, 0, size, thickness};
+          poly = combine(ppp_star(s), ppp_circle(c), PP_XOR);
         }break;
         case 16: {
           ppp_arc_def p = {0, 0, size, 0, 30, 290};
@@ -0,0 +1,64 @@
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#define PP_IMPLEMENTATION
+#include "pretty-poly.h"
+#define PPP_IMPLEMENTATION
+#include "pretty-poly-primitives.h"
+#include "helpers.h"
+
+const int WIDTH = 1024;
+const int HEIGHT = 1024;
+colour buffer[1024][1024];
+
+colour pen;
+void set_pen(colour c) {
+  pen = c;
+}
+
+void blend_tile(const pp_tile_t *t) {
+  for(int32_t y = t->y; y < t->y + t->h; y++) {
+    for(int32_t x = t->x; x < t->x + t->w; x++) {     
+      colour alpha_pen = pen;
+      alpha_pen.a = alpha(pen.a, pp_tile_get(t, x, y));
+      buffer[y][x] = blend(buffer[y][x], alpha_pen);
+    }
+  }
+}
+
+// benchmark for the fixed per-tile overhead, renders 10,000 polygons that are
+// each only a few pixels across
+int main() {
+  pp_tile_callback(blend_tile);
+  pp_antialias(PP_AA_X4);
+  pp_clip(0, 0, WIDTH, HEIGHT);
+
+  const int count = 10000;
+  pp_poly_t *polys[3] = {
+    ppp_regular((ppp_regular_def){0, 0, 3, 3}),
+    ppp_star((ppp_star_def){0, 0, 5, 4, 2}),
+    ppp_rect((ppp_rect_def){-2, -2, 4, 4})
+  };
+
+  srand(0);
+  uint64_t start = time_ms();
+
+  for(int i = 0; i < count; i++) {
+    pp_mat3_t t = pp_mat3_identity();
+    pp_mat3_translate(&t, rand() % WIDTH, rand() % HEIGHT);
+    pp_mat3_rotate(&t, rand() % 360);
+    pp_transform(&t);
+
+    set_pen(create_colour_hsv((float)i / (float)count, 1.0f, 1.0f, 1.0f));
+    pp_render(polys[i % 3]);
+  }
+
+  uint64_t end = time_ms();
+  printf("rendered %d tiny polygons in %lums\n", count, (unsigned long)(end - start));
+
+  for(int i = 0; i < 3; i++) pp_poly_free(polys[i]);
+
+  stbi_write_png("/tmp/out.png", WIDTH, HEIGHT, 4, (void *)buffer, WIDTH * sizeof(uint32_t));
+
+  return 0;
+}
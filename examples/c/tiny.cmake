@@ -0,0 +1,6 @@
+add_executable(
+  tiny
+  tiny.c
+)
+
+target_link_libraries(tiny m)
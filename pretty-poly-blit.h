@@ -0,0 +1,596 @@
+/*
+
+  Pretty Poly 🦜 - super-sampling polygon renderer for low resource platforms.
+
+  Jonathan Williamson, August 2022
+  Examples, source, and more: https://github.com/lowfatcode/pretty-poly
+  MIT License https://github.com/lowfatcode/pretty-poly/blob/main/LICENSE
+
+  An easy way to render high quality graphics in embedded applications running
+  on resource constrained microcontrollers such as the Cortex M0 and up.
+
+  Blitters: composite a rendered tile into a framebuffer with a solid colour
+  or a per-pixel paint.
+
+    - 32bpp RGBA8888 and BGRA8888 framebuffers
+    - 16bpp RGB565, 8bpp RGB332, and 8bpp palette framebuffers
+    - 1bpp monochrome framebuffers, a byte at a time from packed tiles
+    - SSE2 and AVX2 kernels when compiled for x86 (define PPB_NO_SIMD to
+      always use the portable versions), results are identical either way
+    - Zero coverage skipped, full coverage of opaque colours stored directly
+    - Packed 4bpp and 1bpp tiles expanded by ppb_tile() for every target
+
+  Contributor bwaaaaaarks! 🦜
+
+    @MichaelBell - lots of bug fixes, performance boosts, and suggestions.
+    @gadgetoid - integrating into the PicoVector library and testing.
+
+*/
+
+#ifndef PPB_INCLUDE_H
+#define PPB_INCLUDE_H
+
+#include "pretty-poly.h"
+
+#if !defined(PPB_NO_SIMD) && defined(__AVX2__)
+#define PPB_AVX2
+#include <immintrin.h>
+#elif !defined(PPB_NO_SIMD) && defined(__SSE2__)
+#define PPB_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifndef PPB_RAMP_LEVELS
+#define PPB_RAMP_LEVELS 16  // coverage levels in a palette blend ramp
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// colours are packed 32-bit values with the channels in memory order, for
+// RGBA8888 that is 0xAABBGGRR on little endian machines. pixels are blended
+// with the same arithmetic as the examples' helpers:
+//
+//   a = ((colour alpha + 1) * coverage) >> 8
+//   c = (dest * (256 - a) + src * a + 127) >> 8   (for r, g, b)
+//   alpha = max(dest alpha, a)
+//
+// with pixels where a == 255 set to the colour
+
+// paint callback, writes the colours for `w` pixels starting at (x, y) into
+// `colours` in the framebuffer's channel order
+typedef void (*ppb_paint_t)(int32_t x, int32_t y, int32_t w, uint32_t *colours, void *data);
+
+// `fb` is the first pixel of the framebuffer and `stride` its row length in
+// pixels, the tile is composited at its own position. these kernels read one
+// coverage byte per pixel (PP_TILE_8BPP), ppb_tile() expands packed tiles for
+// them
+void ppb_blit_rgba8888(const pp_tile_t *tile, uint32_t *fb, int32_t stride, uint32_t colour);
+void ppb_blit_bgra8888(const pp_tile_t *tile, uint32_t *fb, int32_t stride, uint32_t colour);
+void ppb_paint_8888(const pp_tile_t *tile, uint32_t *fb, int32_t stride, ppb_paint_t paint, void *data);
+
+// front to back drawing (see pp_occlusion()), the framebuffer starts cleared
+// to zero and holds the premultiplied colour and opacity drawn so far. each
+// pixel is blended *under* it:
+//
+//   w = (255 - dest alpha) * a / 255
+//   c = dest + src * w / 255   (for r, g, b)
+//   alpha = dest alpha + w
+//
+// once an opaque background has been drawn last every pixel is opaque and the
+// framebuffer is ordinary RGBA8888
+void ppb_blit_under_rgba8888(const pp_tile_t *tile, uint32_t *fb, int32_t stride, uint32_t colour);
+
+// packed formats are blended with 33 levels of alpha, the colour is still
+// given as 0xAABBGGRR and converted once per tile
+uint16_t ppb_rgb565(uint32_t colour);
+uint8_t ppb_rgb332(uint32_t colour);
+void ppb_blit_rgb565(const pp_tile_t *tile, uint16_t *fb, int32_t stride, uint32_t colour);
+void ppb_blit_rgb332(const pp_tile_t *tile, uint8_t *fb, int32_t stride, uint32_t colour);
+
+// palette blend ramp, the palette index to write for each coverage level
+// (1 to PPB_RAMP_LEVELS) and existing palette index. build one per colour
+// with ppb_ramp() and keep it for as long as the colour is in use
+typedef struct {
+  uint8_t lut[PPB_RAMP_LEVELS][256];
+} ppb_ramp_t;
+
+void ppb_ramp(ppb_ramp_t *ramp, const uint32_t *palette, int count, uint32_t colour);
+void ppb_blit_palette(const pp_tile_t *tile, uint8_t *fb, int32_t stride, const ppb_ramp_t *ramp);
+
+// 1bpp framebuffer with the leftmost pixel in the most significant bit and
+// `stride` in bytes. pixels covered by the tile are set (or cleared when
+// `ink` is false). PP_TILE_1BPP and PP_TILE_1BPP_DITHER tiles are copied a
+// byte at a time, other formats are thresholded at 50%
+void ppb_blit_1bpp(const pp_tile_t *tile, uint8_t *fb, int32_t stride, bool ink);
+
+// render target for ppb_tile(), pass ppb_tile to pp_tile_callback() and
+// select the target (and with it the format and colour) before each render
+typedef enum {
+  PPB_RGBA8888 = 0,
+  PPB_BGRA8888 = 1,
+  PPB_RGB565   = 2,
+  PPB_RGB332   = 3,
+  PPB_PALETTE  = 4,
+  PPB_1BPP     = 5,            // ink when the colour's average channel >= 128
+  PPB_RGBA8888_UNDER = 6       // front to back, see ppb_blit_under_rgba8888()
+} ppb_format_t;
+
+typedef struct {
+  ppb_format_t format;
+  void *fb;                    // first pixel of the framebuffer
+  int32_t stride;              // row length in pixels (bytes for PPB_1BPP)
+  uint32_t colour;             // 0xAABBGGRR
+  const ppb_ramp_t *ramp;      // PPB_PALETTE only
+  ppb_paint_t paint;           // PPB_RGBA8888 and PPB_BGRA8888 only, used
+  void *paint_data;            // instead of `colour` when set
+} ppb_target_t;
+
+void ppb_target(const ppb_target_t *target);
+void ppb_tile(const pp_tile_t *tile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef PPB_IMPLEMENTATION
+
+#ifndef PPB_PAINT_ROW
+#define PPB_PAINT_ROW 256   // pixels painted per call to the paint callback
+#endif
+
+#ifndef PPB_UNPACK_ROW
+#define PPB_UNPACK_ROW 256  // pixels of a packed tile expanded at a time
+#endif
+
+uint32_t _ppb_blend_8888(uint32_t d, uint32_t s, uint32_t cov) {
+  uint32_t a = (((s >> 24) + 1) * cov) >> 8;
+  if(a == 0) return d;
+  if(a == 255) return s;
+
+  // red and blue are blended together, each lane stays below 65536
+  uint32_t ia = 256 - a;
+  uint32_t rb = ((((d & 0x00ff00ff) * ia) + ((s & 0x00ff00ff) * a) + 0x007f007f) >> 8) & 0x00ff00ff;
+  uint32_t g = ((((d >> 8) & 0xff) * ia) + (((s >> 8) & 0xff) * a) + 127) >> 8;
+  uint32_t da = d >> 24;
+  return rb | (g << 8) | ((da > a ? da : a) << 24);
+}
+
+// x / 255 rounded to nearest for x up to 65535
+uint32_t _ppb_div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+uint32_t _ppb_under_8888(uint32_t d, uint32_t s, uint32_t cov) {
+  uint32_t a = (((s >> 24) + 1) * cov) >> 8;
+  uint32_t da = d >> 24;
+  uint32_t w = _ppb_div255((255 - da) * a);
+  if(w == 0) return d;
+  if(w == 255) return s | 0xff000000; // opaque over an empty pixel
+
+  uint32_t result = (da + w) << 24;
+  for(int shift = 0; shift < 24; shift += 8) {
+    uint32_t c = ((d >> shift) & 0xff) + _ppb_div255(((s >> shift) & 0xff) * w);
+    result |= (c > 255 ? 255 : c) << shift;
+  }
+  return result;
+}
+
+// portable row kernel, `src` is either NULL (solid colour `colour`) or one
+// colour per pixel
+void _ppb_row_8888_scalar(uint32_t *dst, const uint8_t *cov, int32_t w, const uint32_t *src, uint32_t colour) {
+  bool opaque = !src && (colour >> 24) == 255;
+  for(int32_t x = 0; x < w; x++) {
+    uint32_t c = cov[x];
+    if(c == 0) continue;
+    if(opaque && c == 255) { dst[x] = colour; continue; }
+    dst[x] = _ppb_blend_8888(dst[x], src ? src[x] : colour, c);
+  }
+}
+
+#if defined(PPB_SSE2) || defined(PPB_AVX2)
+// blend 4 pixels where `cb` holds each pixel's coverage in all four channels
+__m128i _ppb_blend_sse2(__m128i d, __m128i s, __m128i cb) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi16(1), c256 = _mm_set1_epi16(256), c127 = _mm_set1_epi16(127);
+  const __m128i amask = _mm_set1_epi32(0xff000000);
+
+  __m128i dlo = _mm_unpacklo_epi8(d, zero), dhi = _mm_unpackhi_epi8(d, zero);
+  __m128i slo = _mm_unpacklo_epi8(s, zero), shi = _mm_unpackhi_epi8(s, zero);
+
+  // a = ((source alpha + 1) * coverage) >> 8 in every channel
+  __m128i salo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, 0xff), 0xff);
+  __m128i sahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, 0xff), 0xff);
+  __m128i alo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(cb, zero), _mm_add_epi16(salo, one)), 8);
+  __m128i ahi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(cb, zero), _mm_add_epi16(sahi, one)), 8);
+
+  __m128i rlo = _mm_add_epi16(_mm_mullo_epi16(dlo, _mm_sub_epi16(c256, alo)), _mm_mullo_epi16(slo, alo));
+  __m128i rhi = _mm_add_epi16(_mm_mullo_epi16(dhi, _mm_sub_epi16(c256, ahi)), _mm_mullo_epi16(shi, ahi));
+  rlo = _mm_srli_epi16(_mm_add_epi16(rlo, c127), 8);
+  rhi = _mm_srli_epi16(_mm_add_epi16(rhi, c127), 8);
+  __m128i r = _mm_packus_epi16(rlo, rhi);
+
+  // alpha is the larger of the two, fully covered pixels take the source
+  __m128i a = _mm_packus_epi16(alo, ahi);
+  r = _mm_or_si128(_mm_andnot_si128(amask, r), _mm_and_si128(amask, _mm_max_epu8(d, a)));
+  __m128i full = _mm_cmpeq_epi8(a, _mm_set1_epi8((char)0xff));
+  return _mm_or_si128(_mm_and_si128(full, s), _mm_andnot_si128(full, r));
+}
+#endif
+
+#ifdef PPB_AVX2
+// blend 8 pixels, same arithmetic as _ppb_blend_sse2
+__m256i _ppb_blend_avx2(__m256i d, __m256i s, __m256i cb) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi16(1), c256 = _mm256_set1_epi16(256), c127 = _mm256_set1_epi16(127);
+  const __m256i amask = _mm256_set1_epi32(0xff000000);
+
+  __m256i dlo = _mm256_unpacklo_epi8(d, zero), dhi = _mm256_unpackhi_epi8(d, zero);
+  __m256i slo = _mm256_unpacklo_epi8(s, zero), shi = _mm256_unpackhi_epi8(s, zero);
+
+  __m256i salo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(slo, 0xff), 0xff);
+  __m256i sahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(shi, 0xff), 0xff);
+  __m256i alo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(cb, zero), _mm256_add_epi16(salo, one)), 8);
+  __m256i ahi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(cb, zero), _mm256_add_epi16(sahi, one)), 8);
+
+  __m256i rlo = _mm256_add_epi16(_mm256_mullo_epi16(dlo, _mm256_sub_epi16(c256, alo)), _mm256_mullo_epi16(slo, alo));
+  __m256i rhi = _mm256_add_epi16(_mm256_mullo_epi16(dhi, _mm256_sub_epi16(c256, ahi)), _mm256_mullo_epi16(shi, ahi));
+  rlo = _mm256_srli_epi16(_mm256_add_epi16(rlo, c127), 8);
+  rhi = _mm256_srli_epi16(_mm256_add_epi16(rhi, c127), 8);
+  __m256i r = _mm256_packus_epi16(rlo, rhi);
+
+  __m256i a = _mm256_packus_epi16(alo, ahi);
+  r = _mm256_blendv_epi8(r, _mm256_max_epu8(d, a), amask);
+  __m256i full = _mm256_cmpeq_epi8(a, _mm256_set1_epi8((char)0xff));
+  return _mm256_blendv_epi8(r, s, full);
+}
+#endif
+
+void _ppb_row_8888(uint32_t *dst, const uint8_t *cov, int32_t w, const uint32_t *src, uint32_t colour) {
+  int32_t x = 0;
+
+#if defined(PPB_SSE2) || defined(PPB_AVX2)
+  bool opaque = !src && (colour >> 24) == 255;
+#endif
+
+#ifdef PPB_AVX2
+  const __m256i solid8 = _mm256_set1_epi32(colour);
+  // each pixel's coverage byte copied into all four of its channels
+  const __m256i spread8 = _mm256_setr_epi8(
+    0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12,
+    0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12);
+  for(; x + 8 <= w; x += 8) {
+    uint64_t c; memcpy(&c, cov + x, 8);
+    if(c == 0) continue;
+    if(opaque && c == UINT64_MAX) { _mm256_storeu_si256((__m256i *)(dst + x), solid8); continue; }
+    __m256i cb = _mm256_shuffle_epi8(_mm256_cvtepu8_epi32(_mm_cvtsi64_si128(c)), spread8);
+    __m256i s = src ? _mm256_loadu_si256((const __m256i *)(src + x)) : solid8;
+    __m256i d = _mm256_loadu_si256((const __m256i *)(dst + x));
+    _mm256_storeu_si256((__m256i *)(dst + x), _ppb_blend_avx2(d, s, cb));
+  }
+#endif
+
+#if defined(PPB_SSE2) || defined(PPB_AVX2)
+  const __m128i solid4 = _mm_set1_epi32(colour);
+  for(; x + 4 <= w; x += 4) {
+    uint32_t c; memcpy(&c, cov + x, 4);
+    if(c == 0) continue;
+    if(opaque && c == UINT32_MAX) { _mm_storeu_si128((__m128i *)(dst + x), solid4); continue; }
+    __m128i cb = _mm_cvtsi32_si128(c);
+    cb = _mm_unpacklo_epi8(cb, cb);
+    cb = _mm_unpacklo_epi16(cb, cb);
+    __m128i s = src ? _mm_loadu_si128((const __m128i *)(src + x)) : solid4;
+    __m128i d = _mm_loadu_si128((const __m128i *)(dst + x));
+    _mm_storeu_si128((__m128i *)(dst + x), _ppb_blend_sse2(d, s, cb));
+  }
+#endif
+
+  _ppb_row_8888_scalar(dst + x, cov + x, w - x, src ? src + x : NULL, colour);
+}
+
+void ppb_blit_rgba8888(const pp_tile_t *tile, uint32_t *fb, int32_t stride, uint32_t colour) {
+  uint32_t *dst = fb + tile->x + tile->y * stride;
+  const uint8_t *cov = tile->data;
+  for(int32_t y = 0; y < tile->h; y++) {
+    _ppb_row_8888(dst, cov, tile->w, NULL, colour);
+    dst += stride;
+    cov += tile->stride;
+  }
+}
+
+void ppb_blit_bgra8888(const pp_tile_t *tile, uint32_t *fb, int32_t stride, uint32_t colour) {
+  // swap red and blue once, the blend treats every channel the same
+  colour = (colour & 0xff00ff00) | ((colour & 0xff) << 16) | ((colour >> 16) & 0xff);
+  ppb_blit_rgba8888(tile, fb, stride, colour);
+}
+
+void ppb_blit_under_rgba8888(const pp_tile_t *tile, uint32_t *fb, int32_t stride, uint32_t colour) {
+  uint32_t *dst = fb + tile->x + tile->y * stride;
+  const uint8_t *cov = tile->data;
+  for(int32_t y = 0; y < tile->h; y++) {
+    for(int32_t x = 0; x < tile->w; x++) {
+      if(cov[x] && dst[x] < 0xff000000) dst[x] = _ppb_under_8888(dst[x], colour, cov[x]);
+    }
+    dst += stride;
+    cov += tile->stride;
+  }
+}
+
+void ppb_paint_8888(const pp_tile_t *tile, uint32_t *fb, int32_t stride, ppb_paint_t paint, void *data) {
+  uint32_t colours[PPB_PAINT_ROW];
+  uint32_t *dst = fb + tile->x + tile->y * stride;
+  const uint8_t *cov = tile->data;
+  for(int32_t y = 0; y < tile->h; y++) {
+    for(int32_t x = 0; x < tile->w; x += PPB_PAINT_ROW) {
+      int32_t w = _pp_min(PPB_PAINT_ROW, tile->w - x);
+      paint(tile->x + x, tile->y + y, w, colours, data);
+      _ppb_row_8888(dst + x, cov + x, w, colours, 0);
+    }
+    dst += stride;
+    cov += tile->stride;
+  }
+}
+
+// -- packed formats ------------------------------------------------------------
+//
+// a pixel's channels are spread out across a 32-bit word with enough space
+// between them that all three can be blended with a single multiply by a
+// 0 - 32 alpha
+
+uint32_t _ppb_alpha32(uint32_t colour, uint32_t cov) {
+  return (((((colour >> 24) + 1) * cov) >> 8) + 4) >> 3;
+}
+
+uint32_t _ppb_spread_565(uint32_t c) {
+  return (c | c << 16) & 0x07e0f81f;
+}
+
+uint16_t _ppb_blend_565(uint16_t d, uint32_t s, uint32_t a) {
+  uint32_t r = ((_ppb_spread_565(d) * (32 - a) + s * a) >> 5) & 0x07e0f81f;
+  return (uint16_t)(r | r >> 16);
+}
+
+// a word of two pixels blended with the same alpha without spreading them
+// out: the blue and red of one pixel and the green of the other already have
+// room above them in place, the remaining three do once shifted down by five.
+// `se` and `so` are the source colour split the same way
+uint32_t _ppb_blend_565x2(uint32_t d, uint32_t se, uint32_t so, uint32_t a) {
+  uint32_t e = (((d & 0x07e0f81f) * (32 - a) + se * a) >> 5) & 0x07e0f81f;
+  uint32_t o = ((((d >> 5) & 0x07c0f83f) * (32 - a) + so * a) >> 5) & 0x07c0f83f;
+  return e | o << 5;
+}
+
+uint16_t ppb_rgb565(uint32_t colour) {
+  uint32_t r = colour & 0xff, g = (colour >> 8) & 0xff, b = (colour >> 16) & 0xff;
+  return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+uint8_t ppb_rgb332(uint32_t colour) {
+  uint32_t r = colour & 0xff, g = (colour >> 8) & 0xff, b = (colour >> 16) & 0xff;
+  return (uint8_t)((r & 0xe0) | ((g >> 3) & 0x1c) | (b >> 6));
+}
+
+void ppb_blit_rgb565(const pp_tile_t *tile, uint16_t *fb, int32_t stride, uint32_t colour) {
+  uint16_t c = ppb_rgb565(colour);
+  uint32_t s = _ppb_spread_565(c), solid = c | (uint32_t)c << 16;
+  uint32_t se = solid & 0x07e0f81f, so = (solid >> 5) & 0x07c0f83f;
+  bool opaque = (colour >> 24) == 255;
+
+  uint16_t *dst = fb + tile->x + tile->y * stride;
+  const uint8_t *cov = tile->data;
+  for(int32_t y = 0; y < tile->h; y++) {
+    int32_t x = 0;
+
+    // one pixel to reach a word boundary
+    if(((uintptr_t)dst & 2) && tile->w > 0) {
+      uint32_t a = _ppb_alpha32(colour, cov[0]);
+      if(a) dst[0] = _ppb_blend_565(dst[0], s, a);
+      x = 1;
+    }
+
+    // then two pixels per word, blended together when their coverage is the
+    // same (the inside of a shape) and one at a time along edges
+    for(; x + 2 <= tile->w; x += 2) {
+      uint16_t c2; memcpy(&c2, cov + x, 2);
+      if(c2 == 0) continue;
+      if(opaque && c2 == 0xffff) { memcpy(dst + x, &solid, 4); continue; }
+      uint32_t w; memcpy(&w, dst + x, 4);
+      if(cov[x] == cov[x + 1]) {
+        w = _ppb_blend_565x2(w, se, so, _ppb_alpha32(colour, cov[x]));
+        memcpy(dst + x, &w, 4);
+        continue;
+      }
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      uint32_t a0 = _ppb_alpha32(colour, cov[x + 1]), a1 = _ppb_alpha32(colour, cov[x]);
+#else
+      uint32_t a0 = _ppb_alpha32(colour, cov[x]), a1 = _ppb_alpha32(colour, cov[x + 1]);
+#endif
+      uint32_t lo = _ppb_blend_565((uint16_t)w, s, a0);
+      uint32_t hi = _ppb_blend_565((uint16_t)(w >> 16), s, a1);
+      w = lo | hi << 16;
+      memcpy(dst + x, &w, 4);
+    }
+
+    if(x < tile->w) {
+      uint32_t a = _ppb_alpha32(colour, cov[x]);
+      if(a) dst[x] = _ppb_blend_565(dst[x], s, a);
+    }
+
+    dst += stride;
+    cov += tile->stride;
+  }
+}
+
+uint32_t _ppb_spread_332(uint32_t c) {
+  return ((c & 0xe0) << 12) | ((c & 0x1c) << 6) | (c & 0x03);
+}
+
+uint8_t _ppb_blend_332(uint8_t d, uint32_t s, uint32_t a) {
+  uint32_t r = ((_ppb_spread_332(d) * (32 - a) + s * a) >> 5) & 0x000e0703;
+  return (uint8_t)((r >> 12) | (r >> 6) | r);
+}
+
+void ppb_blit_rgb332(const pp_tile_t *tile, uint8_t *fb, int32_t stride, uint32_t colour) {
+  uint8_t c = ppb_rgb332(colour);
+  uint32_t s = _ppb_spread_332(c);
+  bool opaque = (colour >> 24) == 255;
+
+  uint8_t *dst = fb + tile->x + tile->y * stride;
+  const uint8_t *cov = tile->data;
+  for(int32_t y = 0; y < tile->h; y++) {
+    int32_t x = 0;
+    // skip or fill four pixels at a time where the coverage allows
+    for(; x + 4 <= tile->w; x += 4) {
+      uint32_t c4; memcpy(&c4, cov + x, 4);
+      if(c4 == 0) continue;
+      if(opaque && c4 == UINT32_MAX) { memset(dst + x, c, 4); continue; }
+      for(int i = x; i < x + 4; i++) {
+        uint32_t a = _ppb_alpha32(colour, cov[i]);
+        if(a) dst[i] = _ppb_blend_332(dst[i], s, a);
+      }
+    }
+    for(; x < tile->w; x++) {
+      uint32_t a = _ppb_alpha32(colour, cov[x]);
+      if(a) dst[x] = _ppb_blend_332(dst[x], s, a);
+    }
+    dst += stride;
+    cov += tile->stride;
+  }
+}
+
+// -- palettes ------------------------------------------------------------------
+
+int _ppb_nearest(const uint32_t *palette, int count, uint32_t c) {
+  int best = 0;
+  uint32_t best_d = UINT32_MAX;
+  for(int i = 0; i < count; i++) {
+    int32_t dr = (int32_t)(palette[i] & 0xff) - (int32_t)(c & 0xff);
+    int32_t dg = (int32_t)((palette[i] >> 8) & 0xff) - (int32_t)((c >> 8) & 0xff);
+    int32_t db = (int32_t)((palette[i] >> 16) & 0xff) - (int32_t)((c >> 16) & 0xff);
+    uint32_t d = dr * dr + dg * dg + db * db;
+    if(d < best_d) { best_d = d; best = i; }
+  }
+  return best;
+}
+
+void ppb_ramp(ppb_ramp_t *ramp, const uint32_t *palette, int count, uint32_t colour) {
+  count = _pp_min(count, 256);
+  for(int l = 0; l < PPB_RAMP_LEVELS; l++) {
+    uint32_t cov = ((l + 1) * 255) / PPB_RAMP_LEVELS;
+    for(int i = 0; i < 256; i++) {
+      // indices outside of the palette are left alone
+      ramp->lut[l][i] = i < count ?
+        _ppb_nearest(palette, count, _ppb_blend_8888(palette[i], colour, cov)) : i;
+    }
+  }
+}
+
+void ppb_blit_palette(const pp_tile_t *tile, uint8_t *fb, int32_t stride, const ppb_ramp_t *ramp) {
+  uint8_t *dst = fb + tile->x + tile->y * stride;
+  const uint8_t *cov = tile->data;
+  for(int32_t y = 0; y < tile->h; y++) {
+    int32_t x = 0;
+    for(; x + 4 <= tile->w; x += 4) {
+      uint32_t c4; memcpy(&c4, cov + x, 4);
+      if(c4 == 0) continue;
+      for(int i = x; i < x + 4; i++) {
+        uint32_t l = (cov[i] * PPB_RAMP_LEVELS + 128) >> 8;
+        if(l) dst[i] = ramp->lut[l - 1][dst[i]];
+      }
+    }
+    for(; x < tile->w; x++) {
+      uint32_t l = (cov[x] * PPB_RAMP_LEVELS + 128) >> 8;
+      if(l) dst[x] = ramp->lut[l - 1][dst[x]];
+    }
+    dst += stride;
+    cov += tile->stride;
+  }
+}
+
+// -- monochrome ------------------------------------------------------------------
+
+void ppb_blit_1bpp(const pp_tile_t *tile, uint8_t *fb, int32_t stride, bool ink) {
+  int32_t shift = tile->x & 7;
+  uint8_t *dst = fb + (tile->x >> 3) + tile->y * stride;
+  bool packed = tile->format == PP_TILE_1BPP || tile->format == PP_TILE_1BPP_DITHER;
+  for(int32_t y = 0; y < tile->h; y++) {
+    const uint8_t *src = tile->data + y * tile->stride;
+    for(int32_t x = 0; x < tile->w; x += 8) {
+      uint8_t bits = 0;
+      if(packed) {
+        bits = src[x >> 3]; // bits past the end of the row are zero
+      } else {
+        for(int32_t i = 0; i < 8 && x + i < tile->w; i++) {
+          bits |= (pp_tile_get(tile, tile->x + x + i, tile->y + y) >= 128) << (7 - i);
+        }
+      }
+      if(!bits) continue;
+
+      // the eight pixels straddle two framebuffer bytes unless aligned
+      uint8_t *d = dst + (x >> 3);
+      uint8_t a = bits >> shift, b = shift ? (uint8_t)(bits << (8 - shift)) : 0;
+      if(ink) { d[0] |= a; if(b) d[1] |= b; }
+      else    { d[0] &= ~a; if(b) d[1] &= ~b; }
+    }
+    dst += stride;
+  }
+}
+
+// -- render target -------------------------------------------------------------
+
+ppb_target_t _ppb_target;
+
+void ppb_target(const ppb_target_t *target) {
+  _ppb_target = *target;
+}
+
+void _ppb_tile_8bpp(const pp_tile_t *tile) {
+  const ppb_target_t *t = &_ppb_target;
+  switch(t->format) {
+    case PPB_RGBA8888:
+    case PPB_BGRA8888: {
+      if(t->paint) {
+        ppb_paint_8888(tile, (uint32_t *)t->fb, t->stride, t->paint, t->paint_data);
+      } else if(t->format == PPB_RGBA8888) {
+        ppb_blit_rgba8888(tile, (uint32_t *)t->fb, t->stride, t->colour);
+      } else {
+        ppb_blit_bgra8888(tile, (uint32_t *)t->fb, t->stride, t->colour);
+      }
+    } break;
+    case PPB_RGBA8888_UNDER: ppb_blit_under_rgba8888(tile, (uint32_t *)t->fb, t->stride, t->colour); break;
+    case PPB_RGB565: ppb_blit_rgb565(tile, (uint16_t *)t->fb, t->stride, t->colour); break;
+    case PPB_RGB332: ppb_blit_rgb332(tile, (uint8_t *)t->fb, t->stride, t->colour); break;
+    case PPB_PALETTE: ppb_blit_palette(tile, (uint8_t *)t->fb, t->stride, t->ramp); break;
+    case PPB_1BPP: {
+      uint32_t sum = (t->colour & 0xff) + ((t->colour >> 8) & 0xff) + ((t->colour >> 16) & 0xff);
+      ppb_blit_1bpp(tile, (uint8_t *)t->fb, t->stride, sum >= 3 * 128);
+    } break;
+  }
+}
+
+void ppb_tile(const pp_tile_t *tile) {
+  if(tile->format == PP_TILE_8BPP || _ppb_target.format == PPB_1BPP) {
+    _ppb_tile_8bpp(tile);
+    return;
+  }
+
+  // packed tiles are expanded to 8bpp a row (or part of one) at a time and
+  // passed on as tiles one pixel high
+  uint8_t row[PPB_UNPACK_ROW];
+  pp_tile_t t = {.h = 1, .stride = PPB_UNPACK_ROW, .data = row, .antialias = tile->antialias, .format = PP_TILE_8BPP};
+  for(int32_t y = 0; y < tile->h; y++) {
+    for(int32_t x = 0; x < tile->w; x += PPB_UNPACK_ROW) {
+      t.x = tile->x + x;
+      t.y = tile->y + y;
+      t.w = _pp_min(PPB_UNPACK_ROW, tile->w - x);
+      for(int32_t i = 0; i < t.w; i++) row[i] = pp_tile_get(tile, t.x + i, t.y);
+      _ppb_tile_8bpp(&t);
+    }
+  }
+}
+
+#endif // PPB_IMPLEMENTATION
+
+#endif // PPB_INCLUDE_H
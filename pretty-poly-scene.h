@@ -0,0 +1,436 @@
+/*
+
+  Pretty Poly 🦜 - super-sampling polygon renderer for low resource platforms.
+
+  Jonathan Williamson, August 2022
+  Examples, source, and more: https://github.com/lowfatcode/pretty-poly
+  MIT License https://github.com/lowfatcode/pretty-poly/blob/main/LICENSE
+
+  An easy way to render high quality graphics in embedded applications running
+  on resource constrained microcontrollers such as the Cortex M0 and up.
+
+  Scenes: record a list of polygons and render them a band of rows at a time
+  for displays without a framebuffer.
+
+    - Every polygon touching a band is composited into a band sized buffer
+      which is then passed to your flush callback (e.g. to push it over SPI)
+    - Any pretty-poly-blit.h format: RGBA8888, BGRA8888, RGB565, RGB332,
+      palette, and 1bpp
+    - Each polygon keeps the colour, transform, clip, and antialias level it
+      was added with
+    - Or composite a scene into a framebuffer one screen tile at a time so
+      every framebuffer pixel is written exactly once per frame
+    - Or prepare a mostly static scene once and replay it every frame with
+      only span filling and blending left to do
+
+  Contributor bwaaaaaarks! 🦜
+
+    @MichaelBell - lots of bug fixes, performance boosts, and suggestions.
+    @gadgetoid - integrating into the PicoVector library and testing.
+
+*/
+
+#ifndef PPS_INCLUDE_H
+#define PPS_INCLUDE_H
+
+#include "pretty-poly.h"
+#include "pretty-poly-blit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  pp_poly_t *poly;             // not owned by the scene
+  uint32_t colour;             // 0xAABBGGRR
+  const ppb_ramp_t *ramp;      // PPB_PALETTE only
+  pp_mat3_t transform;
+  bool transformed;
+  pp_rect_t clip;
+  pp_antialias_t antialias;
+  pp_rect_t bounds;            // on screen, updated by pps_render()
+  pp_prepared_t *prepared;     // set by pps_prepare(), owned by the scene
+} pps_item_t;
+
+typedef struct {
+  pps_item_t *items;
+  int count, storage;
+  int *bins, bin_storage;      // per screen tile item lists, see pps_composite()
+} pps_scene_t;
+
+typedef struct {
+  ppb_format_t format;
+  int32_t w, h;                // size of the display
+  int32_t band_h;              // rows per band
+  void *buffer;                // band buffer of w x band_h pixels
+  uint32_t background;         // colour each band is cleared to, a palette
+                               // index for PPB_PALETTE
+} pps_target_t;
+
+typedef struct {
+  ppb_format_t format;
+  void *fb;                    // framebuffer
+  int32_t stride;              // in pixels, or bytes for PPB_1BPP
+  int32_t w, h;                // size of the framebuffer
+  int32_t tile_w, tile_h;      // size of the screen tiles, tile_w must be a
+                               // multiple of 8 for PPB_1BPP
+  void *buffer;                // tile colour buffer of tile_w x tile_h pixels
+  uint32_t background;         // colour each tile is cleared to, a palette
+                               // index for PPB_PALETTE
+} pps_framebuffer_t;
+
+// called with each band once every polygon touching it has been drawn,
+// `pixels` holds `h` rows starting at row `y` of the display
+typedef void (*pps_flush_t)(int32_t y, int32_t h, const void *pixels, void *data);
+
+pps_scene_t *pps_scene_new();
+void pps_scene_free(pps_scene_t *scene);
+void pps_scene_clear(pps_scene_t *scene);
+
+// add a polygon to the end of the draw list with the current transform, clip,
+// and antialias level (see pp_transform(), pp_clip(), and pp_antialias())
+pps_item_t *pps_add(pps_scene_t *scene, pp_poly_t *poly, uint32_t colour);
+
+// render the scene band by band, draw order is the order items were added.
+// the clip rectangle is respected and the tile callback, blit target (see
+// ppb_target()), transform, antialias level, and clip are restored afterwards
+void pps_render(pps_scene_t *scene, const pps_target_t *target, pps_flush_t flush, void *data);
+
+// composite the scene into a framebuffer a screen tile at a time. items are
+// binned to the screen tiles they touch and each tile is built up in the tile
+// colour buffer from its items in draw order before being written to the
+// framebuffer once. the tile buffer (see pp_tile_buffer()) is used for each
+// item's coverage and should be at least tile_w x tile_h. an item is
+// rasterised again for every screen tile it touches so this is slower than
+// rendering into the framebuffer directly, it only saves framebuffer traffic.
+// settings are restored afterwards as with pps_render()
+void pps_composite(pps_scene_t *scene, const pps_framebuffer_t *target);
+
+// build the nodes of every item once (see pp_prepare()) with the current tile
+// buffer size so that pps_draw() only has to fill spans and blend. call again
+// if any item's polygon changes
+void pps_prepare(pps_scene_t *scene);
+
+// draw every item in order straight into the framebuffer clipped to its own
+// clip rectangle, prepared items are replayed and the rest rendered as usual.
+// settings are restored afterwards as with pps_render()
+void pps_draw(pps_scene_t *scene, const ppb_target_t *target);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef PPS_IMPLEMENTATION
+
+pps_scene_t *pps_scene_new() {
+  pps_scene_t *scene = malloc(sizeof(pps_scene_t));
+  scene->storage = 16;
+  scene->count = 0;
+  scene->items = malloc(sizeof(pps_item_t) * scene->storage);
+  scene->bins = NULL;
+  scene->bin_storage = 0;
+  return scene;
+}
+
+void pps_scene_free(pps_scene_t *scene) {
+  pps_scene_clear(scene);
+  free(scene->items);
+  free(scene->bins);
+  free(scene);
+}
+
+void pps_scene_clear(pps_scene_t *scene) {
+  for(int i = 0; i < scene->count; i++) {
+    if(scene->items[i].prepared) pp_prepared_free(scene->items[i].prepared);
+  }
+  scene->count = 0;
+}
+
+pps_item_t *pps_add(pps_scene_t *scene, pp_poly_t *poly, uint32_t colour) {
+  if(scene->count == scene->storage) { // no storage left, double buffer size
+    scene->storage *= 2;
+    scene->items = realloc(scene->items, sizeof(pps_item_t) * scene->storage);
+  }
+  pps_item_t *item = &scene->items[scene->count++];
+  *item = (pps_item_t){
+    .poly = poly, .colour = colour,
+    .transform = _pp_transform ? *_pp_transform : pp_mat3_identity(),
+    .transformed = _pp_transform != NULL,
+    .clip = _pp_clip,
+    .antialias = _pp_antialias
+  };
+  return item;
+}
+
+// top left of the band or screen tile being rendered
+int32_t _pps_origin_x, _pps_origin_y;
+
+// tiles are clipped to the band or screen tile, move them into its buffer's
+// coordinates
+void _pps_tile(const pp_tile_t *tile) {
+  pp_tile_t t = *tile;
+  t.x -= _pps_origin_x;
+  t.y -= _pps_origin_y;
+  ppb_tile(&t);
+}
+
+void _pps_clear(ppb_format_t format, void *buffer, int32_t w, int32_t h, uint32_t c) {
+  int32_t n = w * h;
+  switch(format) {
+    case PPB_RGBA8888:
+    case PPB_RGBA8888_UNDER:
+    case PPB_BGRA8888: {
+      if(format == PPB_BGRA8888) c = (c & 0xff00ff00) | ((c & 0xff) << 16) | ((c >> 16) & 0xff);
+      uint32_t *p = (uint32_t *)buffer;
+      for(int32_t i = 0; i < n; i++) p[i] = c;
+    } break;
+    case PPB_RGB565: {
+      uint16_t v = ppb_rgb565(c), *p = (uint16_t *)buffer;
+      for(int32_t i = 0; i < n; i++) p[i] = v;
+    } break;
+    case PPB_RGB332: memset(buffer, ppb_rgb332(c), n); break;
+    case PPB_PALETTE: memset(buffer, c & 0xff, n); break;
+    case PPB_1BPP: {
+      uint32_t sum = (c & 0xff) + ((c >> 8) & 0xff) + ((c >> 16) & 0xff);
+      memset(buffer, sum >= 3 * 128 ? 0xff : 0x00, ((w + 7) >> 3) * h);
+    } break;
+  }
+}
+
+// screen bounds of every item so that bands and screen tiles only visit the
+// items that touch them
+void _pps_bounds(pps_scene_t *scene, pp_rect_t *screen) {
+  for(int i = 0; i < scene->count; i++) {
+    pps_item_t *item = &scene->items[i];
+    item->bounds = pp_poly_bounds(item->poly);
+    if(item->transformed) item->bounds = pp_rect_transform(&item->bounds, &item->transform);
+    item->bounds = pp_rect_intersection(&item->bounds, screen);
+    item->bounds = pp_rect_intersection(&item->bounds, &item->clip);
+  }
+}
+
+// make the item's settings current, clipped to `r`
+void _pps_setup(pps_item_t *item, pp_rect_t *r) {
+  pp_rect_t clip = pp_rect_intersection(r, &item->clip);
+  pp_clip(clip.x, clip.y, clip.w, clip.h);
+  pp_transform(item->transformed ? &item->transform : NULL);
+  pp_antialias(item->antialias);
+}
+
+// draw one item clipped to `r` into the buffer described by `target`
+void _pps_draw(pps_item_t *item, pp_rect_t *r, const ppb_target_t *target) {
+  ppb_target_t t = *target;
+  t.colour = item->colour;
+  t.ramp = item->ramp;
+  ppb_target(&t);
+  _pps_setup(item, r);
+  pp_render(item->poly);
+}
+
+void pps_render(pps_scene_t *scene, const pps_target_t *target, pps_flush_t flush, void *data) {
+  pp_rect_t clip = _pp_clip;
+  pp_tile_callback_t callback = _pp_tile_callback;
+  pp_mat3_t *transform = _pp_transform;
+  pp_antialias_t antialias = _pp_antialias;
+  ppb_target_t blit = _ppb_target;
+
+  pp_rect_t screen = {0, 0, target->w, target->h};
+  screen = pp_rect_intersection(&screen, &clip);
+  _pps_bounds(scene, &screen);
+
+  ppb_target_t band_target = {
+    .format = target->format, .fb = target->buffer,
+    .stride = target->format == PPB_1BPP ? (target->w + 7) >> 3 : target->w
+  };
+  pp_tile_callback(_pps_tile);
+  _pps_origin_x = 0;
+
+  for(int32_t y = 0; y < target->h; y += target->band_h) {
+    int32_t h = _pp_min(target->band_h, target->h - y);
+    pp_rect_t band = {0, y, target->w, h};
+    band = pp_rect_intersection(&band, &screen);
+
+    _pps_origin_y = y;
+    _pps_clear(target->format, target->buffer, target->w, h, target->background);
+
+    for(int i = 0; i < scene->count; i++) {
+      pps_item_t *item = &scene->items[i];
+      if(item->bounds.y >= y + h || item->bounds.y + item->bounds.h <= y || pp_rect_empty(&item->bounds)) continue;
+      _pps_draw(item, &band, &band_target);
+    }
+
+    flush(y, h, target->buffer, data);
+  }
+
+  _pp_clip = clip;
+  pp_tile_callback(callback);
+  pp_transform(transform);
+  pp_antialias(antialias);
+  ppb_target(&blit);
+}
+
+// copy the part `r` of the screen tile at `x`, `y` from the tile colour
+// buffer into the framebuffer
+void _pps_write(const pps_framebuffer_t *target, int32_t x, int32_t y, const pp_rect_t *r) {
+  if(target->format == PPB_1BPP) {
+    // screen tiles start on a byte boundary so bits line up, only the bytes at
+    // either end of a row may be shared with pixels outside of `r`
+    int32_t tile_stride = (target->tile_w + 7) >> 3;
+    int32_t b0 = r->x >> 3, b1 = (r->x + r->w - 1) >> 3;
+    uint8_t m0 = 0xff >> (r->x & 7), m1 = 0xff << (7 - ((r->x + r->w - 1) & 7));
+    if(b0 == b1) m0 = m1 = m0 & m1;
+    for(int32_t row = r->y; row < r->y + r->h; row++) {
+      const uint8_t *src = (const uint8_t *)target->buffer + (row - y) * tile_stride - (x >> 3);
+      uint8_t *dst = (uint8_t *)target->fb + row * target->stride;
+      dst[b0] = (dst[b0] & ~m0) | (src[b0] & m0);
+      if(b1 > b0) {
+        memcpy(dst + b0 + 1, src + b0 + 1, b1 - b0 - 1);
+        dst[b1] = (dst[b1] & ~m1) | (src[b1] & m1);
+      }
+    }
+    return;
+  }
+
+  int bpp = target->format == PPB_RGB565 ? 2 :
+            target->format == PPB_RGB332 || target->format == PPB_PALETTE ? 1 : 4;
+  const uint8_t *src = (const uint8_t *)target->buffer + ((r->y - y) * target->tile_w + (r->x - x)) * bpp;
+  uint8_t *dst = (uint8_t *)target->fb + (r->y * target->stride + r->x) * bpp;
+  for(int32_t row = 0; row < r->h; row++) {
+    memcpy(dst, src, r->w * bpp);
+    src += target->tile_w * bpp;
+    dst += target->stride * bpp;
+  }
+}
+
+void pps_composite(pps_scene_t *scene, const pps_framebuffer_t *target) {
+  pp_rect_t clip = _pp_clip;
+  pp_tile_callback_t callback = _pp_tile_callback;
+  pp_mat3_t *transform = _pp_transform;
+  pp_antialias_t antialias = _pp_antialias;
+  ppb_target_t blit = _ppb_target;
+
+  pp_rect_t screen = {0, 0, target->w, target->h};
+  screen = pp_rect_intersection(&screen, &clip);
+  _pps_bounds(scene, &screen);
+
+  // bin the items: count the items touching each screen tile, turn the counts
+  // into the end of each tile's list, then fill the lists from the back with
+  // the items in reverse so each list is in draw order and `bins[t]` is left
+  // at the start of tile t's list
+  int32_t tw = target->tile_w, th = target->tile_h;
+  int32_t cols = (target->w + tw - 1) / tw, rows = (target->h + th - 1) / th;
+  int tiles = cols * rows, total = 0;
+
+  for(int i = 0; i < scene->count; i++) {
+    pp_rect_t *b = &scene->items[i].bounds;
+    if(pp_rect_empty(b)) continue;
+    total += ((b->x + b->w - 1) / tw - b->x / tw + 1) * ((b->y + b->h - 1) / th - b->y / th + 1);
+  }
+
+  if(scene->bin_storage < tiles + 1 + total) {
+    scene->bin_storage = tiles + 1 + total;
+    scene->bins = realloc(scene->bins, sizeof(int) * scene->bin_storage);
+  }
+  int *bins = scene->bins, *list = bins + tiles + 1;
+  memset(bins, 0, sizeof(int) * (tiles + 1));
+
+  for(int i = 0; i < scene->count; i++) {
+    pp_rect_t *b = &scene->items[i].bounds;
+    if(pp_rect_empty(b)) continue;
+    for(int32_t ty = b->y / th; ty <= (b->y + b->h - 1) / th; ty++) {
+      for(int32_t tx = b->x / tw; tx <= (b->x + b->w - 1) / tw; tx++) {
+        bins[ty * cols + tx]++;
+      }
+    }
+  }
+  for(int t = 1; t <= tiles; t++) bins[t] += bins[t - 1];
+  for(int i = scene->count - 1; i >= 0; i--) {
+    pp_rect_t *b = &scene->items[i].bounds;
+    if(pp_rect_empty(b)) continue;
+    for(int32_t ty = b->y / th; ty <= (b->y + b->h - 1) / th; ty++) {
+      for(int32_t tx = b->x / tw; tx <= (b->x + b->w - 1) / tw; tx++) {
+        list[--bins[ty * cols + tx]] = i;
+      }
+    }
+  }
+
+  ppb_target_t tile_target = {
+    .format = target->format, .fb = target->buffer,
+    .stride = target->format == PPB_1BPP ? (tw + 7) >> 3 : tw
+  };
+  pp_tile_callback(_pps_tile);
+
+  for(int32_t ty = 0; ty < rows; ty++) {
+    for(int32_t tx = 0; tx < cols; tx++) {
+      pp_rect_t r = {tx * tw, ty * th, tw, th};
+      r = pp_rect_intersection(&r, &screen);
+      if(pp_rect_empty(&r)) continue;
+
+      _pps_origin_x = tx * tw;
+      _pps_origin_y = ty * th;
+      _pps_clear(target->format, target->buffer, tw, th, target->background);
+
+      int t = ty * cols + tx;
+      for(int i = bins[t]; i < bins[t + 1]; i++) {
+        _pps_draw(&scene->items[list[i]], &r, &tile_target);
+      }
+
+      _pps_write(target, tx * tw, ty * th, &r);
+    }
+  }
+
+  _pp_clip = clip;
+  pp_tile_callback(callback);
+  pp_transform(transform);
+  pp_antialias(antialias);
+  ppb_target(&blit);
+}
+
+void pps_prepare(pps_scene_t *scene) {
+  pp_rect_t clip = _pp_clip;
+  pp_mat3_t *transform = _pp_transform;
+  pp_antialias_t antialias = _pp_antialias;
+
+  for(int i = 0; i < scene->count; i++) {
+    pps_item_t *item = &scene->items[i];
+    if(item->prepared) pp_prepared_free(item->prepared);
+    _pps_setup(item, &item->clip);
+    item->prepared = pp_prepare(item->poly);
+  }
+
+  _pp_clip = clip;
+  pp_transform(transform);
+  pp_antialias(antialias);
+}
+
+void pps_draw(pps_scene_t *scene, const ppb_target_t *target) {
+  pp_rect_t clip = _pp_clip;
+  pp_tile_callback_t callback = _pp_tile_callback;
+  pp_mat3_t *transform = _pp_transform;
+  pp_antialias_t antialias = _pp_antialias;
+  ppb_target_t blit = _ppb_target;
+
+  pp_tile_callback(ppb_tile);
+  for(int i = 0; i < scene->count; i++) {
+    pps_item_t *item = &scene->items[i];
+    if(item->prepared) {
+      ppb_target_t t = *target;
+      t.colour = item->colour;
+      t.ramp = item->ramp;
+      ppb_target(&t);
+      pp_render_prepared(item->prepared);
+    } else {
+      _pps_draw(item, &item->clip, target);
+    }
+  }
+
+  _pp_clip = clip;
+  pp_tile_callback(callback);
+  pp_transform(transform);
+  pp_antialias(antialias);
+  ppb_target(&blit);
+}
+
+#endif // PPS_IMPLEMENTATION
+
+#endif // PPS_INCLUDE_H
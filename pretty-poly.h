@@ -14,7 +14,7 @@
     - Tile based renderer: low memory footprint, cache coherency
     - Low memory usage: ~4kB of heap memory required
     - High speed on low resource platforms: optionally no floating point
-    - Antialiasing modes: X1 (none), X4 and X16 super sampling
+    - Antialiasing modes: X1 (none), X4, X8 (sparse) and X16 super sampling
     - Bounds clipping: all results clipped to supplied clip rectangle
     - Pixel format agnostic: renders a "tile" to blend into your framebuffer
     - Support for hardware interpolators on rp2040 (thanks @MichaelBell!)
@@ -48,10 +48,40 @@
 #define PP_TILE_BUFFER_SIZE 64
 #endif
 
+#ifndef PP_NODE_BUFFER_HEIGHT
+#define PP_NODE_BUFFER_HEIGHT (PP_TILE_BUFFER_SIZE * 4)
+#endif
+
+#ifndef PP_NODE_POOL_SIZE
+#define PP_NODE_POOL_SIZE (PP_NODE_BUFFER_HEIGHT * 8)
+#endif
+
 #ifndef PP_SCALE_TO_ALPHA
 #define PP_SCALE_TO_ALPHA 1
 #endif
 
+#ifndef PP_CLIP_CACHE_TILES
+#define PP_CLIP_CACHE_TILES 8  // clip path masks kept, a tile buffer each
+#endif
+
+#if defined(PP_STATS) || defined(PP_TRACE)
+#include <stdio.h>
+#endif
+
+#ifdef PP_TRACE
+#ifndef PP_TRACE_EVENTS
+#define PP_TRACE_EVENTS 4096  // size of the trace ring buffer, a power of two
+#endif
+
+#ifndef PP_TRACE_TICKS_PER_US
+#define PP_TRACE_TICKS_PER_US 1000  // PP_CLOCK() ticks per microsecond
+#endif
+
+#ifndef PP_TRACE_TID
+#define PP_TRACE_TID() 0  // e.g. get_core_num() to trace each core separately
+#endif
+#endif
+
 #if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
 #define USE_RP2040_INTERP
 #include "hardware/interp.h"
@@ -91,13 +121,34 @@ pp_rect_t pp_rect_intersection(pp_rect_t *r1, pp_rect_t *r2);
 pp_rect_t pp_rect_merge(pp_rect_t *r1, pp_rect_t *r2);
 pp_rect_t pp_rect_transform(pp_rect_t *r, pp_mat3_t *m);
 
-// antialias levels
-typedef enum {PP_AA_NONE = 0, PP_AA_FAST = 1, PP_AA_X4 = 1, PP_AA_BEST = 2, PP_AA_X16 = 2} pp_antialias_t;
+// antialias levels, the value is also the log2 of the number of sub-scanlines
+// per pixel (X8 is a sparse n-rooks pattern with one sample per sub-scanline,
+// it has twice the sub-scanlines of X16 and so costs about twice as much)
+// PP_AA_AUTO picks a level for each polygon based on its size on screen
+typedef enum {PP_AA_AUTO = -1, PP_AA_NONE = 0, PP_AA_FAST = 1, PP_AA_X4 = 1, PP_AA_BEST = 2, PP_AA_X16 = 2, PP_AA_X8 = 3} pp_antialias_t;
+
+// policy used to pick the antialias level when set to PP_AA_AUTO
+typedef struct {
+  int32_t small;   // polygons smaller than this (in pixels) use X16
+  int32_t large;   // axis aligned polygons at least this large use X1
+  int32_t detail;  // polygons averaging fewer pixels per edge use X16
+} pp_aa_policy_t;
+
+// layout of the tile data passed to the callback. packed formats store the
+// leftmost pixel in the most significant bits of each byte
+typedef enum {
+  PP_TILE_8BPP = 0,           // one alpha value per byte (default)
+  PP_TILE_4BPP = 1,           // two pixels per byte, alpha >> 4
+  PP_TILE_1BPP = 2,           // eight pixels per byte, alpha >= 128
+  PP_TILE_1BPP_DITHER = 3     // eight pixels per byte, 4x4 ordered dither
+} pp_tile_format_t;
 
 typedef struct {
   int32_t x, y, w, h;
-  uint32_t stride;
+  uint32_t stride;            // bytes from one row of `data` to the next
   uint8_t *data;
+  pp_antialias_t antialias;   // level the tile was rendered at
+  pp_tile_format_t format;    // layout of `data`
 } pp_tile_t;
 
 typedef struct _pp_path_t {
@@ -123,19 +174,186 @@ pp_rect_t pp_poly_bounds(pp_poly_t *p);
 int pp_poly_path_count(pp_poly_t *p);
 void pp_poly_merge(pp_poly_t *p, pp_poly_t *m);
 
+// boolean operations on the areas of two polygons, each filled even-odd as
+// it would be rendered
+typedef enum {
+  PP_UNION = 0,               // inside either
+  PP_INTERSECTION = 1,        // inside both
+  PP_DIFFERENCE = 2,          // inside the first but not the second
+  PP_XOR = 3                  // inside exactly one
+} pp_boolean_t;
+pp_poly_t *pp_poly_boolean(pp_poly_t *a, pp_poly_t *b, pp_boolean_t op);
+
+// a copy of a polygon with just enough points to stay within `tolerance`
+// pixels of it when drawn with the current transform
+pp_poly_t *pp_poly_simplify(pp_poly_t *poly, float tolerance);
+
+// levels of detail of a polygon, each a simplified copy and the furthest
+// (in polygon units) any point of the original is from it. pp_render_lod()
+// draws the coarsest level whose error is within the threshold on screen
+typedef struct _pp_lod_level_t {
+  pp_poly_t *poly;
+  float error;
+  struct _pp_lod_level_t *next;   // next coarser level
+} pp_lod_level_t;
+typedef struct {
+  pp_poly_t *poly;            // the original, not owned
+  int points;                 // its point count when the levels were made
+  pp_lod_level_t *levels;     // finest first
+} pp_poly_lod_t;
+pp_poly_lod_t *pp_poly_lod_new(pp_poly_t *poly, int levels);
+void pp_poly_lod_free(pp_poly_lod_t *lod);
+pp_poly_t *pp_poly_lod_select(pp_poly_lod_t *lod);
+
+// a set of disjoint rectangles, e.g. the parts of the screen that need to be
+// redrawn this frame
+typedef struct {
+  pp_rect_t *rects;
+  int count, storage;
+} pp_region_t;
+pp_region_t *pp_region_new();
+void pp_region_free(pp_region_t *region);
+void pp_region_clear(pp_region_t *region);
+void pp_region_add(pp_region_t *region, pp_rect_t r);
+void pp_region_add_damage(pp_region_t *region, pp_poly_t *poly, pp_mat3_t *from, pp_mat3_t *to);
+pp_rect_t pp_region_bounds(pp_region_t *region);
+bool pp_region_intersects(pp_region_t *region, pp_rect_t *r);
+
+// for drawing front to back, a bit for each pixel of a w x h area at 0, 0
+// that is already hidden behind an opaque polygon
+typedef struct {
+  int32_t w, h, stride;       // stride in bytes
+  uint8_t *bits;              // leftmost pixel in the most significant bit
+  int32_t *spans;             // per row, first and last pixel that may be hidden
+} pp_occlusion_t;
+pp_occlusion_t *pp_occlusion_new(int32_t w, int32_t h);
+void pp_occlusion_free(pp_occlusion_t *occlusion);
+void pp_occlusion_clear(pp_occlusion_t *occlusion);
+void pp_occlusion_hide(pp_occlusion_t *occlusion, pp_rect_t r);
+
 // user settings
 typedef void (*pp_tile_callback_t)(const pp_tile_t *tile);
 
 extern pp_rect_t           _pp_clip;
+extern pp_region_t        *_pp_clip_region;
+extern pp_poly_t          *_pp_clip_path;
+extern pp_occlusion_t     *_pp_occlusion;
+extern bool                _pp_opaque;
 extern pp_tile_callback_t  _pp_tile_callback;
 extern pp_antialias_t      _pp_antialias;
+extern pp_aa_policy_t      _pp_aa_policy;
+extern float               _pp_lod_threshold;
 extern pp_mat3_t          *_pp_transform;
+extern uint8_t            *_pp_tile_buffer;
+extern int32_t             _pp_tile_w, _pp_tile_h;
+extern pp_tile_format_t    _pp_tile_format;
 
 void pp_clip(int32_t x, int32_t y, int32_t w, int32_t h);
+void pp_clip_region(pp_region_t *region);
+void pp_clip_path(pp_poly_t *clip);
+void pp_occlusion(pp_occlusion_t *occlusion);
+void pp_opaque(bool opaque);
 void pp_tile_callback(pp_tile_callback_t callback);
+void pp_tile_buffer(uint8_t *buffer, int32_t w, int32_t h);
+void pp_tile_format(pp_tile_format_t format);
+pp_rect_t pp_tile_autotune(uint8_t *buffer, int32_t size, pp_poly_t **scene, int count, uint64_t (*now)());
 void pp_antialias(pp_antialias_t antialias);
+void pp_antialias_policy(pp_aa_policy_t policy);
+void pp_lod_threshold(float pixels);
+pp_antialias_t pp_antialias_auto(pp_poly_t *polygon, pp_rect_t *bounds);
 pp_mat3_t *pp_transform(pp_mat3_t *transform);
 void pp_render(pp_poly_t *polygon);
+void pp_render_lod(pp_poly_lod_t *lod);
+pp_rect_t pp_render_canvas(pp_poly_t *polygon, uint8_t *canvas, int32_t w, int32_t h);
+
+// a polygon prepared for replay: the sorted nodes of every tile it covers, 
+// built once with the transform, clip, antialias level, and tile size at the 
+// time. pp_render_prepared() only fills spans and calls the tile callback
+typedef struct {
+  pp_rect_t bounds;           // on screen, clipped
+  pp_antialias_t antialias;   // level the nodes were built at
+  int32_t tile_w, tile_h;     // largest tile, the tile buffer must be at least this big
+  uint32_t count, storage;    // values used and allocated in `data`
+  int16_t *data;              // per tile: x, y (each as low then high 16 bits), w, h,
+                              // first sub-scanline, sub-scanline count, then each
+                              // sub-scanline's node count and nodes
+} pp_prepared_t;
+pp_prepared_t *pp_prepare(pp_poly_t *polygon);
+void pp_prepared_free(pp_prepared_t *prepared);
+void pp_render_prepared(const pp_prepared_t *prepared);
+size_t pp_prepared_save(const pp_prepared_t *prepared, uint8_t *buffer);
+pp_prepared_t *pp_prepared_load(const uint8_t *buffer, size_t size);
+
+#ifdef PP_STATS
+// render statistics, enabled by defining PP_STATS. counters accumulate over
+// every call to pp_render() until pp_stats_reset() is called. times are in
+// PP_CLOCK() ticks (nanoseconds unless PP_CLOCK is overridden)
+typedef struct {
+  uint32_t polygons, paths, edges;  // submitted to pp_render()
+  uint32_t tiles_visited;           // tiles rasterised (empty + rendered + split)
+  uint32_t tiles_empty;             // tiles with no coverage after rendering
+  uint32_t tiles_rendered;          // tiles passed to the tile callback
+  uint32_t tiles_split;             // tiles split in half as node pool ran out
+  uint32_t tiles_occluded;          // tiles skipped as already hidden
+  uint32_t clip_masks;              // clip path masks rasterised
+  uint32_t clip_mask_hits;          // clip path masks reused from the cache
+  uint32_t nodes;                   // nodes (edge crossings) emitted
+  uint32_t nodes_dropped;           // nodes lost to full sub-scanlines
+  uint32_t max_nodes_per_row;       // most nodes seen on one sub-scanline
+  uint32_t rows;                    // sub-scanline passes (merged rows count once)
+  uint32_t pixels_resolved;         // pixels converted to alpha values
+  uint64_t time_bounds;             // polygon bounds and antialias selection
+  uint64_t time_build;              // building nodes
+  uint64_t time_span;               // sorting nodes and filling spans
+  uint64_t time_resolve;            // converting coverage to alpha (and packing)
+  uint64_t time_callback;           // inside the tile callback
+} pp_stats_t;
+
+extern pp_stats_t          _pp_stats;
+
+const pp_stats_t *pp_stats();
+void pp_stats_reset();
+
+// per tile cost heatmap, while set with pp_heatmap() the cost of each tile 
+// rendered is spread over the cells of a grid aligned to the framebuffer
+typedef enum {PP_HEATMAP_NODES, PP_HEATMAP_ROWS, PP_HEATMAP_TIME} pp_heatmap_metric_t;
+
+typedef struct {
+  int32_t w, h;         // size of the framebuffer area covered (pixels)
+  int32_t cell;         // size of each grid cell (pixels)
+  int32_t cols, rows;   // grid dimensions
+  float *nodes;         // nodes emitted in each cell
+  float *sub_rows;      // sub-scanline passes in each cell
+  float *time;          // PP_CLOCK() ticks spent (excluding tile callback)
+} pp_heatmap_t;
+
+extern pp_heatmap_t       *_pp_heatmap;
+
+pp_heatmap_t *pp_heatmap_new(int32_t w, int32_t h, int32_t cell);
+void pp_heatmap_free(pp_heatmap_t *map);
+void pp_heatmap_clear(pp_heatmap_t *map);
+void pp_heatmap(pp_heatmap_t *map);
+void pp_heatmap_write_csv(pp_heatmap_t *map, pp_heatmap_metric_t metric, FILE *file);
+void pp_heatmap_write_pgm(pp_heatmap_t *map, pp_heatmap_metric_t metric, FILE *file);
+#endif
+
+#ifdef PP_TRACE
+// timeline tracing, enabled by defining PP_TRACE. when turned on with 
+// pp_trace(true) every pp_render() call, tile, and phase within a tile is 
+// recorded into a ring buffer holding the most recent PP_TRACE_EVENTS events
+// which can be written out in chrome trace event format (chrome://tracing or 
+// https://ui.perfetto.dev) with pp_trace_dump()
+typedef struct {
+  const char *name;
+  uint64_t start, end;  // PP_CLOCK() ticks
+  pp_rect_t rect;       // polygon bounds or tile being rendered
+  uint32_t tid;
+} pp_trace_event_t;
+
+void pp_trace(bool enable);
+void pp_trace_reset();
+void pp_trace_dump(FILE *file);
+#endif
 
 
 #ifdef __cplusplus
@@ -157,15 +375,174 @@ void pp_render(pp_poly_t *polygon);
 #define debug(...)
 #endif
 
+#if (defined(PP_STATS) || defined(PP_TRACE)) && !defined(PP_CLOCK)
+#include <time.h>
+uint64_t _pp_clock_ns() {
+  struct timespec ts; timespec_get(&ts, TIME_UTC);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#define PP_CLOCK() _pp_clock_ns()
+#endif
+
+#ifdef PP_TRACE
+// the ring buffer's head is only touched here so that the public declarations
+// stay plain C that C++ can include
+#include <stdatomic.h>
+
+pp_trace_event_t    _pp_trace_events[PP_TRACE_EVENTS];
+atomic_uint         _pp_trace_head = 0;
+bool                _pp_trace_enabled = false;
+
+// the event slot is claimed with a single atomic increment so renders on 
+// multiple cores (or an interrupt) can record events without locking
+void _pp_trace_event(const char *name, uint64_t start, pp_rect_t rect) {
+  uint64_t end = PP_CLOCK();
+  uint32_t i = atomic_fetch_add_explicit(&_pp_trace_head, 1, memory_order_relaxed);
+  _pp_trace_events[i & (PP_TRACE_EVENTS - 1)] = (pp_trace_event_t){name, start, end, rect, PP_TRACE_TID()};
+}
+
+void pp_trace(bool enable) { _pp_trace_enabled = enable; }
+void pp_trace_reset() { atomic_store(&_pp_trace_head, 0); }
+
+// write the recorded events as chrome trace event json, should be called 
+// while nothing is rendering
+void pp_trace_dump(FILE *file) {
+  uint32_t head = atomic_load(&_pp_trace_head);
+  uint32_t count = head < PP_TRACE_EVENTS ? head : PP_TRACE_EVENTS;
+
+  // timestamps are written relative to the earliest event to keep precision
+  uint64_t base = UINT64_MAX;
+  for(uint32_t i = head - count; i != head; i++) {
+    pp_trace_event_t *e = &_pp_trace_events[i & (PP_TRACE_EVENTS - 1)];
+    base = e->start < base ? e->start : base;
+  }
+
+  fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+  for(uint32_t i = head - count; i != head; i++) {
+    pp_trace_event_t *e = &_pp_trace_events[i & (PP_TRACE_EVENTS - 1)];
+    fprintf(file, "%s\n  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %u, ", 
+      i == head - count ? "" : ",", e->name, (unsigned)e->tid);
+    fprintf(file, "\"ts\": %.3f, \"dur\": %.3f, ", 
+      (double)(e->start - base) / PP_TRACE_TICKS_PER_US, (double)(e->end - e->start) / PP_TRACE_TICKS_PER_US);
+    fprintf(file, "\"args\": {\"x\": %d, \"y\": %d, \"w\": %d, \"h\": %d}}", 
+      (int)e->rect.x, (int)e->rect.y, (int)e->rect.w, (int)e->rect.h);
+  }
+  fprintf(file, "\n]}\n");
+}
+
+// record the time from PP_TRACE_BEGIN(var) to PP_TRACE_END(name, var, rect),
+// when tracing is turned off this costs a single branch at each end
+#define PP_TRACE_BEGIN(var) uint64_t var = _pp_trace_enabled ? PP_CLOCK() : 0
+#define PP_TRACE_END(name, var, rect) if(_pp_trace_enabled && var) _pp_trace_event(name, var, rect)
+#else
+#define PP_TRACE_BEGIN(var)
+#define PP_TRACE_END(name, var, rect)
+#endif
+
 pp_rect_t           _pp_clip = (pp_rect_t){-INT_MAX, -INT_MAX, INT_MAX, INT_MAX};
+pp_region_t        *_pp_clip_region = NULL;
+pp_poly_t          *_pp_clip_path = NULL;
+pp_occlusion_t     *_pp_occlusion = NULL;
+bool                _pp_opaque = false;
 pp_tile_callback_t  _pp_tile_callback = NULL;
 pp_antialias_t      _pp_antialias = PP_AA_X4;
+pp_aa_policy_t      _pp_aa_policy = {.small = 32, .large = 64, .detail = 4};
+float               _pp_lod_threshold = 0.25f;
 pp_mat3_t          *_pp_transform = NULL;
+pp_tile_format_t    _pp_tile_format = PP_TILE_8BPP;
+
+// antialias level used by the current render (PP_AA_AUTO resolved)
+pp_antialias_t      _pp_aa = PP_AA_X4;
 
 int     _pp_max(int a, int b) { return a > b ? a : b; }
 int     _pp_min(int a, int b) { return a < b ? a : b; }
 int     _pp_sign(int v) {return (v > 0) - (v < 0);}
 void    _pp_swap(int *a, int *b) {int t = *a; *a = *b; *b = t;}
+int     _pp_floor(PP_COORD_TYPE v) {int i = (int)v; return i - (v < i);}
+int     _pp_ceil(PP_COORD_TYPE v) {int i = (int)v; return i + (v > i);}
+
+// PP_STAT() wraps statements that only update the counters, PP_STAT_DECL()
+// declares a local (e.g. a start time) that only exists when PP_STATS is on
+#ifdef PP_STATS
+#define PP_STAT(...) __VA_ARGS__
+#define PP_STAT_DECL(...) __VA_ARGS__
+pp_stats_t          _pp_stats;
+const pp_stats_t *pp_stats() { return &_pp_stats; }
+void pp_stats_reset() { memset(&_pp_stats, 0, sizeof(_pp_stats)); }
+
+pp_heatmap_t       *_pp_heatmap = NULL;
+
+pp_heatmap_t *pp_heatmap_new(int32_t w, int32_t h, int32_t cell) {
+  pp_heatmap_t *map = (pp_heatmap_t *)PP_MALLOC(sizeof(pp_heatmap_t));
+  map->w = w; map->h = h; map->cell = cell;
+  map->cols = (w + cell - 1) / cell; map->rows = (h + cell - 1) / cell;
+  map->nodes = (float *)PP_CALLOC(map->cols * map->rows * 3, sizeof(float));
+  map->sub_rows = map->nodes + map->cols * map->rows;
+  map->time = map->sub_rows + map->cols * map->rows;
+  return map;
+}
+
+void pp_heatmap_free(pp_heatmap_t *map) {
+  if(_pp_heatmap == map) _pp_heatmap = NULL;
+  PP_FREE(map->nodes);
+  PP_FREE(map);
+}
+
+void pp_heatmap_clear(pp_heatmap_t *map) {
+  memset(map->nodes, 0, map->cols * map->rows * 3 * sizeof(float));
+}
+
+void pp_heatmap(pp_heatmap_t *map) {
+  _pp_heatmap = map;
+}
+
+// spread the cost of tile tb over the cells it overlaps by area
+void _pp_heatmap_add(pp_heatmap_t *map, pp_rect_t tb, uint32_t nodes, uint32_t rows, uint64_t time) {
+  float area = (float)(tb.w * tb.h);
+  int32_t c = map->cell;
+  for(int32_t cy = _pp_max(tb.y / c, 0); cy < _pp_min((tb.y + tb.h + c - 1) / c, map->rows); cy++) {
+    for(int32_t cx = _pp_max(tb.x / c, 0); cx < _pp_min((tb.x + tb.w + c - 1) / c, map->cols); cx++) {
+      pp_rect_t cr = {cx * c, cy * c, c, c};
+      pp_rect_t o = pp_rect_intersection(&cr, &tb);
+      if(pp_rect_empty(&o)) continue;
+      float share = (float)(o.w * o.h) / area;
+      int i = cx + cy * map->cols;
+      map->nodes[i] += nodes * share;
+      map->sub_rows[i] += rows * share;
+      map->time[i] += time * share;
+    }
+  }
+}
+
+float *_pp_heatmap_values(pp_heatmap_t *map, pp_heatmap_metric_t metric) {
+  return metric == PP_HEATMAP_NODES ? map->nodes : metric == PP_HEATMAP_ROWS ? map->sub_rows : map->time;
+}
+
+// one line per row of cells, values separated by commas
+void pp_heatmap_write_csv(pp_heatmap_t *map, pp_heatmap_metric_t metric, FILE *file) {
+  float *v = _pp_heatmap_values(map, metric);
+  for(int32_t y = 0; y < map->rows; y++) {
+    for(int32_t x = 0; x < map->cols; x++) {
+      fprintf(file, "%s%.1f", x ? "," : "", v[x + y * map->cols]);
+    }
+    fprintf(file, "\n");
+  }
+}
+
+// greyscale image with one pixel per cell, scaled so the costliest cell is white
+void pp_heatmap_write_pgm(pp_heatmap_t *map, pp_heatmap_metric_t metric, FILE *file) {
+  float *v = _pp_heatmap_values(map, metric);
+  float max = 0;
+  for(int32_t i = 0; i < map->cols * map->rows; i++) max = v[i] > max ? v[i] : max;
+  fprintf(file, "P5\n%d %d\n255\n", (int)map->cols, (int)map->rows);
+  for(int32_t i = 0; i < map->cols * map->rows; i++) {
+    fputc(max > 0 ? (int)(v[i] * 255.0f / max + 0.5f) : 0, file);
+  }
+}
+#else
+#define PP_STAT(...)
+#define PP_STAT_DECL(...)
+#endif
 
 // pp_mat3_t implementation
 pp_mat3_t pp_mat3_identity() {
@@ -243,22 +620,30 @@ pp_rect_t pp_rect_transform(pp_rect_t *r, pp_mat3_t *m) {
   bl = pp_point_transform(&bl, m);
   br = pp_point_transform(&br, m);
 
-  PP_COORD_TYPE minx = _pp_min(tl.x, _pp_min(tr.x, _pp_min(bl.x, br.x)));
-  PP_COORD_TYPE miny = _pp_min(tl.y, _pp_min(tr.y, _pp_min(bl.y, br.y)));
-  PP_COORD_TYPE maxx = _pp_max(tl.x, _pp_max(tr.x, _pp_max(bl.x, br.x)));
-  PP_COORD_TYPE maxy = _pp_max(tl.y, _pp_max(tr.y, _pp_max(bl.y, br.y)));
+  // round outwards so that partially covered pixels are always included
+  int32_t minx = _pp_min(_pp_floor(tl.x), _pp_min(_pp_floor(tr.x), _pp_min(_pp_floor(bl.x), _pp_floor(br.x))));
+  int32_t miny = _pp_min(_pp_floor(tl.y), _pp_min(_pp_floor(tr.y), _pp_min(_pp_floor(bl.y), _pp_floor(br.y))));
+  int32_t maxx = _pp_max(_pp_ceil(tl.x), _pp_max(_pp_ceil(tr.x), _pp_max(_pp_ceil(bl.x), _pp_ceil(br.x))));
+  int32_t maxy = _pp_max(_pp_ceil(tl.y), _pp_max(_pp_ceil(tr.y), _pp_max(_pp_ceil(bl.y), _pp_ceil(br.y))));
 
   return (pp_rect_t){
-    .x = (int32_t)minx, 
-    .y = (int32_t)miny, 
-    .w = (int32_t)(maxx - minx), 
-    .h = (int32_t)(maxy - miny)
+    .x = minx, 
+    .y = miny, 
+    .w = maxx - minx, 
+    .h = maxy - miny
   };
 }
 
-// pp_tile_t implementation
+// pp_tile_t implementation, packed formats are expanded to 0 - 255
 uint8_t pp_tile_get(const pp_tile_t *tile, const int32_t x, const int32_t y) {
-  return tile->data[(x - tile->x) + (y - tile->y) * PP_TILE_BUFFER_SIZE];
+  int32_t px = x - tile->x;
+  const uint8_t *row = tile->data + (y - tile->y) * tile->stride;
+  switch(tile->format) {
+    case PP_TILE_4BPP: return ((row[px >> 1] >> ((~px & 1) << 2)) & 0xf) * 17;
+    case PP_TILE_1BPP:
+    case PP_TILE_1BPP_DITHER: return ((row[px >> 3] >> (~px & 7)) & 1) * 255;
+    default: return row[px];
+  }
 }
 
 pp_poly_t *pp_poly_new() {
@@ -356,19 +741,523 @@ void pp_path_add_points(pp_path_t *path, pp_point_t *points, int count) {
 pp_rect_t pp_path_bounds(const pp_path_t *path) {  
   int minx = INT_MAX, maxx = -INT_MAX, miny = INT_MAX, maxy = -INT_MAX;
   for(int i = 0; i < path->count; i++) {
-    minx = _pp_min(minx, path->points[i].x);
-    miny = _pp_min(miny, path->points[i].y);
-    maxx = _pp_max(maxx, path->points[i].x); 
-    maxy = _pp_max(maxy, path->points[i].y);
+    minx = _pp_min(minx, _pp_floor(path->points[i].x));
+    miny = _pp_min(miny, _pp_floor(path->points[i].y));
+    maxx = _pp_max(maxx, _pp_ceil(path->points[i].x)); 
+    maxy = _pp_max(maxy, _pp_ceil(path->points[i].y));
   }
   return (pp_rect_t){minx, miny, maxx - minx, maxy - miny};
 }
 
+// -- boolean operations
+//
+// both polygons are broken into edges which are split wherever they cross or
+// touch another edge, until edges only meet at their end points. each edge is
+// then kept if the result is inside on one side of it and outside on the
+// other (found by counting the edges of each polygon crossed by a ray from
+// its middle) and the edges kept are joined up into contours. points are
+// snapped to 1/PP_BOOLEAN_GRID of a unit so that all of this is exact integer
+// arithmetic and points where edges meet compare equal
+#define PP_BOOLEAN_GRID 256
+
+typedef struct {int32_t x, y;} boolean_point_t;
+
+typedef struct {
+  boolean_point_t a, b;       // a before b (by x, then y) unless directed
+  uint8_t operand;            // 0 for the first polygon, 1 for the second
+  bool used;                  // already part of an output contour
+} boolean_edge_t;
+
+typedef struct {
+  boolean_edge_t *edges;
+  int count, storage;
+} boolean_edges_t;
+
+typedef struct {
+  int edge;                   // edge to split
+  int64_t along;              // distance along the edge, for sorting
+  boolean_point_t p;
+} boolean_split_t;
+
+bool boolean_equal(boolean_point_t a, boolean_point_t b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+// twice the signed area of triangle o, a, b (zero if they are collinear)
+int64_t boolean_cross(boolean_point_t o, boolean_point_t a, boolean_point_t b) {
+  return (int64_t)(a.x - o.x) * (b.y - o.y) - (int64_t)(a.y - o.y) * (b.x - o.x);
+}
+
+int64_t boolean_dot(boolean_point_t o, boolean_point_t a, boolean_point_t b) {
+  return (int64_t)(a.x - o.x) * (b.x - o.x) + (int64_t)(a.y - o.y) * (b.y - o.y);
+}
+
+boolean_point_t boolean_snap(pp_point_t p) {
+  return (boolean_point_t){
+    (int32_t)floorf(p.x * PP_BOOLEAN_GRID + 0.5f), (int32_t)floorf(p.y * PP_BOOLEAN_GRID + 0.5f)
+  };
+}
+
+void boolean_push(boolean_edges_t *list, boolean_edge_t edge) {
+  if(list->count == list->storage) {
+    list->storage = list->storage ? list->storage * 2 : 64;
+    list->edges = realloc(list->edges, sizeof(boolean_edge_t) * list->storage);
+  }
+  list->edges[list->count++] = edge;
+}
+
+// add the undirected edge a to b, unless it has no length
+void boolean_add_edge(boolean_edges_t *list, boolean_point_t a, boolean_point_t b, uint8_t operand) {
+  if(boolean_equal(a, b)) return;
+  if(a.x > b.x || (a.x == b.x && a.y > b.y)) { boolean_point_t t = a; a = b; b = t; }
+  boolean_push(list, (boolean_edge_t){.a = a, .b = b, .operand = operand});
+}
+
+void boolean_add_path(boolean_edges_t *list, pp_path_t *path, uint8_t operand) {
+  if(path->count < 2) return;
+  boolean_point_t last = boolean_snap(path->points[path->count - 1]);
+  for(int i = 0; i < path->count; i++) {
+    boolean_point_t next = boolean_snap(path->points[i]);
+    boolean_add_edge(list, last, next, operand);
+    last = next;
+  }
+}
+
+// true if p (on the line through edge e) is strictly between its end points
+bool boolean_within(const boolean_edge_t *e, boolean_point_t p) {
+  int64_t d = boolean_dot(e->a, p, e->b);
+  return d > 0 && d < boolean_dot(e->a, e->b, e->b);
+}
+
+void boolean_add_split(boolean_split_t **splits, int *count, int *storage, const boolean_edge_t *edges, int edge, boolean_point_t p) {
+  if(*count == *storage) {
+    *storage = *storage ? *storage * 2 : 64;
+    *splits = realloc(*splits, sizeof(boolean_split_t) * *storage);
+  }
+  (*splits)[(*count)++] = (boolean_split_t){edge, boolean_dot(edges[edge].a, p, edges[edge].b), p};
+}
+
+int compare_splits(const void *a, const void *b) {
+  const boolean_split_t *sa = a, *sb = b;
+  if(sa->edge != sb->edge) return sa->edge - sb->edge;
+  return (sa->along > sb->along) - (sa->along < sb->along);
+}
+
+// split every edge where another crosses or touches it, returns false once
+// there was nothing left to split
+bool boolean_split(boolean_edges_t *list) {
+  boolean_split_t *splits = NULL;
+  int count = 0, storage = 0;
+  boolean_edge_t *edges = list->edges;
+
+  for(int i = 0; i < list->count; i++) {
+    boolean_edge_t *e = &edges[i];
+    int32_t eminy = _pp_min(e->a.y, e->b.y), emaxy = _pp_max(e->a.y, e->b.y);
+    for(int j = i + 1; j < list->count; j++) {
+      boolean_edge_t *f = &edges[j];
+      if(f->a.x > e->b.x || f->b.x < e->a.x) continue;
+      if(_pp_min(f->a.y, f->b.y) > emaxy || _pp_max(f->a.y, f->b.y) < eminy) continue;
+
+      // end points lying on the other edge, this includes overlapping edges
+      int64_t d1 = boolean_cross(e->a, e->b, f->a), d2 = boolean_cross(e->a, e->b, f->b);
+      int64_t d3 = boolean_cross(f->a, f->b, e->a), d4 = boolean_cross(f->a, f->b, e->b);
+      if(d1 == 0 && boolean_within(e, f->a)) boolean_add_split(&splits, &count, &storage, edges, i, f->a);
+      if(d2 == 0 && boolean_within(e, f->b)) boolean_add_split(&splits, &count, &storage, edges, i, f->b);
+      if(d3 == 0 && boolean_within(f, e->a)) boolean_add_split(&splits, &count, &storage, edges, j, e->a);
+      if(d4 == 0 && boolean_within(f, e->b)) boolean_add_split(&splits, &count, &storage, edges, j, e->b);
+
+      // the edges cross, the crossing is snapped to the grid which can
+      // introduce new crossings that are found on the next pass
+      if(((d1 < 0 && d2 > 0) || (d1 > 0 && d2 < 0)) && ((d3 < 0 && d4 > 0) || (d3 > 0 && d4 < 0))) {
+        double t = (double)d3 / (double)(d3 - d4);
+        boolean_point_t p = {
+          e->a.x + (int32_t)floor((e->b.x - e->a.x) * t + 0.5), e->a.y + (int32_t)floor((e->b.y - e->a.y) * t + 0.5)
+        };
+        if(!boolean_equal(p, e->a) && !boolean_equal(p, e->b)) boolean_add_split(&splits, &count, &storage, edges, i, p);
+        if(!boolean_equal(p, f->a) && !boolean_equal(p, f->b)) boolean_add_split(&splits, &count, &storage, edges, j, p);
+      }
+    }
+  }
+
+  if(!count) return false;
+
+  // replace the split edges with their pieces
+  qsort(splits, count, sizeof(boolean_split_t), compare_splits);
+  boolean_edges_t result = {0};
+  for(int i = 0, s = 0; i < list->count; i++) {
+    boolean_point_t last = edges[i].a;
+    for(; s < count && splits[s].edge == i; s++) {
+      boolean_add_edge(&result, last, splits[s].p, edges[i].operand);
+      last = splits[s].p;
+    }
+    boolean_add_edge(&result, last, edges[i].b, edges[i].operand);
+  }
+  free(splits);
+  free(list->edges);
+  *list = result;
+  return true;
+}
+
+int compare_boolean_edges(const void *a, const void *b) {
+  const boolean_edge_t *ea = a, *eb = b;
+  if(ea->a.x != eb->a.x) return ea->a.x < eb->a.x ? -1 : 1;
+  if(ea->a.y != eb->a.y) return ea->a.y < eb->a.y ? -1 : 1;
+  if(ea->b.x != eb->b.x) return ea->b.x < eb->b.x ? -1 : 1;
+  if(ea->b.y != eb->b.y) return ea->b.y < eb->b.y ? -1 : 1;
+  return 0;
+}
+
+bool boolean_inside(bool a, bool b, pp_boolean_t op) {
+  switch(op) {
+    case PP_UNION: return a || b;
+    case PP_INTERSECTION: return a && b;
+    case PP_DIFFERENCE: return a && !b;
+    default: return a != b;
+  }
+}
+
+// keep the edges (from `first`, `count` identical edges) that have the result
+// inside on one side only, directed so that the inside is on their left (as
+// seen on screen with y pointing down)
+void boolean_classify(boolean_edges_t *list, int first, int count, pp_boolean_t op, boolean_edges_t *kept) {
+  boolean_edge_t e = list->edges[first];
+  bool horizontal = e.a.y == e.b.y;
+
+  // cast a ray from the middle of the edge (in doubled coordinates so that
+  // the middle is exact) towards +x, or +y if the edge is horizontal. every
+  // edge of a polygon it crosses toggles whether the +x (or +y) side is
+  // inside that polygon
+  int64_t mx = (int64_t)e.a.x + e.b.x, my = (int64_t)e.a.y + e.b.y;
+  bool plus[2] = {false, false}, minus[2];
+  int identical[2] = {0, 0};
+  for(int i = 0; i < list->count; i++) {
+    boolean_edge_t *f = &list->edges[i];
+    if(i >= first && i < first + count) { identical[f->operand]++; continue; }
+
+    int64_t px = 2 * (int64_t)f->a.x, py = 2 * (int64_t)f->a.y, qx = 2 * (int64_t)f->b.x, qy = 2 * (int64_t)f->b.y;
+    if(horizontal) { int64_t t = px; px = py; py = t; t = qx; qx = qy; qy = t; }
+    int64_t rx = horizontal ? my : mx, ry = horizontal ? mx : my;
+    if((py > ry) == (qy > ry)) continue;
+    int64_t side = (px - rx) * (qy - py) + (ry - py) * (qx - px);
+    if(qy > py ? side > 0 : side < 0) plus[f->operand] = !plus[f->operand];
+  }
+
+  // the edges themselves separate the two sides
+  minus[0] = plus[0] != (identical[0] & 1);
+  minus[1] = plus[1] != (identical[1] & 1);
+  bool inside_plus = boolean_inside(plus[0], plus[1], op);
+  if(inside_plus == boolean_inside(minus[0], minus[1], op)) return;
+
+  // a is before b so a to b heads towards +x (or +y if vertical)
+  bool forwards = horizontal ? !inside_plus : (e.b.y > e.a.y) == inside_plus;
+  boolean_push(kept, forwards ? (boolean_edge_t){.a = e.a, .b = e.b} : (boolean_edge_t){.a = e.b, .b = e.a});
+}
+
+// add the contour made of the points in `points` to the polygon, skipping
+// points that lie on a straight line between their neighbours
+void boolean_add_contour(pp_poly_t *poly, boolean_point_t *points, int count) {
+  int n = 0;
+  for(int i = 0; i < count; i++) {
+    while(n >= 2 && boolean_cross(points[n - 2], points[n - 1], points[i]) == 0) n--;
+    points[n++] = points[i];
+  }
+  // and where the contour closes
+  int start = 0;
+  bool changed = true;
+  while(changed && n - start >= 3) {
+    changed = false;
+    if(boolean_cross(points[n - 2], points[n - 1], points[start]) == 0) { n--; changed = true; }
+    else if(boolean_cross(points[n - 1], points[start], points[start + 1]) == 0) { start++; changed = true; }
+  }
+  if(n - start < 3) return;
+
+  pp_path_t *path = pp_poly_add_path(poly);
+  for(int i = start; i < n; i++) {
+    pp_path_add_point(path, (pp_point_t){
+      (PP_COORD_TYPE)points[i].x / PP_BOOLEAN_GRID, (PP_COORD_TYPE)points[i].y / PP_BOOLEAN_GRID
+    });
+  }
+}
+
+// join the directed edges into contours. where more than one edge leaves a
+// point the one turning furthest to the left (towards the inside) is taken so
+// that shapes touching at a corner become separate contours
+pp_poly_t *boolean_contours(boolean_edges_t *kept) {
+  pp_poly_t *poly = pp_poly_new();
+  if(!kept->count) return poly;
+  qsort(kept->edges, kept->count, sizeof(boolean_edge_t), compare_boolean_edges);
+
+  boolean_point_t *points = malloc(sizeof(boolean_point_t) * (kept->count + 1));
+  for(int i = 0; i < kept->count; i++) {
+    if(kept->edges[i].used) continue;
+
+    int count = 0, e = i;
+    while(e >= 0) {
+      boolean_edge_t *edge = &kept->edges[e];
+      edge->used = true;
+      points[count++] = edge->a;
+      if(boolean_equal(edge->b, kept->edges[i].a)) break;
+
+      // find the edges leaving edge->b, they are sorted by their start point
+      int lo = 0, hi = kept->count;
+      while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        boolean_point_t p = kept->edges[mid].a;
+        if(p.x < edge->b.x || (p.x == edge->b.x && p.y < edge->b.y)) lo = mid + 1; else hi = mid;
+      }
+
+      double dx = edge->b.x - edge->a.x, dy = edge->b.y - edge->a.y, best = -4;
+      e = -1;
+      for(int j = lo; j < kept->count && boolean_equal(kept->edges[j].a, edge->b); j++) {
+        if(kept->edges[j].used) continue;
+        double ox = kept->edges[j].b.x - edge->b.x, oy = kept->edges[j].b.y - edge->b.y;
+        double turn = atan2(ox * dy - oy * dx, ox * dx + oy * dy);
+        if(turn > best) { best = turn; e = j; }
+      }
+    }
+    boolean_add_contour(poly, points, count);
+  }
+  free(points);
+  return poly;
+}
+
+// combine the paths of `a` and `b` (either may be NULL), returns a new
+// polygon
+pp_poly_t *boolean_paths(pp_path_t *a, bool a_only, pp_path_t *b, bool b_only, pp_boolean_t op) {
+  boolean_edges_t list = {0}, kept = {0};
+  for(pp_path_t *path = a; path; path = a_only ? NULL : path->next) boolean_add_path(&list, path, 0);
+  for(pp_path_t *path = b; path; path = b_only ? NULL : path->next) boolean_add_path(&list, path, 1);
+
+  // snapping crossings to the grid can add new crossings, though rarely more
+  // than once
+  for(int pass = 0; pass < 16 && boolean_split(&list); pass++) {}
+
+  // identical edges (from overlapping contours) end up next to each other
+  if(list.count) qsort(list.edges, list.count, sizeof(boolean_edge_t), compare_boolean_edges);
+  for(int i = 0; i < list.count;) {
+    int count = 1;
+    while(i + count < list.count && compare_boolean_edges(&list.edges[i], &list.edges[i + count]) == 0) count++;
+    boolean_classify(&list, i, count, op, &kept);
+    i += count;
+  }
+
+  pp_poly_t *result = boolean_contours(&kept);
+  free(list.edges);
+  free(kept.edges);
+  return result;
+}
+
+// replace `path` with the union of it and `other`. if that is more than one
+// contour (the two don't overlap, or enclose a hole) the rest are linked in
+// after `path`. `path` is left as it is if neither has any area
 void pp_path_union(pp_path_t *path, pp_path_t *other) {
+  pp_poly_t *result = boolean_paths(path, true, other, true, PP_UNION);
+  pp_path_t *first = result->paths;
+  if(first) {
+    pp_point_t *points = path->points;
+    path->points = first->points; path->count = first->count; path->storage = first->storage;
+    first->points = points;
+
+    // move the other contours into the list after `path`
+    pp_path_t *rest = first->next, *tail = rest;
+    while(tail && tail->next) tail = tail->next;
+    if(rest) { tail->next = path->next; path->next = rest; }
+    first->next = NULL;
+  }
+  pp_poly_free(result);
+}
 
+// a new polygon covering the area given by combining `a` and `b` with `op`.
+// self intersections and overlapping contours of each are resolved even-odd
+// (as they would be rendered) and the result is made of non-overlapping
+// contours with no redundant points, so `pp_poly_boolean(a, NULL, PP_UNION)`
+// reduces a polygon to its minimal outline. points are snapped to 1/256th of
+// a unit, takes time proportional to the square of the number of edges
+pp_poly_t *pp_poly_boolean(pp_poly_t *a, pp_poly_t *b, pp_boolean_t op) {
+  return boolean_paths(a ? a->paths : NULL, false, b ? b->paths : NULL, false, op);
 }
 
-pp_rect_t pp_polygon_bounds(pp_poly_t *p) {
+// -- simplification
+//
+// each contour is reduced with douglas-peucker: starting from two points that
+// must be kept (the leftmost and the one furthest from it) the point furthest
+// from the segment between each pair of kept points is kept too, until every
+// point dropped is within the tolerance of the segment that replaces it.
+// duplicate and collinear points are within any tolerance, so they always go
+
+// largest factor the transform `m` scales a length by
+float simplify_scale(pp_mat3_t *m) {
+  if(!m) return 1.0f;
+  float e = m->v00 * m->v00 + m->v01 * m->v01 + m->v10 * m->v10 + m->v11 * m->v11;
+  float d = m->v00 * m->v11 - m->v01 * m->v10;
+  return sqrtf((e + sqrtf(fmaxf(e * e - 4.0f * d * d, 0.0f))) / 2.0f);
+}
+
+// squared distance of `p` from the segment `a` to `b`
+float simplify_distance(pp_point_t p, pp_point_t a, pp_point_t b) {
+  float dx = b.x - a.x, dy = b.y - a.y, px = p.x - a.x, py = p.y - a.y;
+  float l = dx * dx + dy * dy;
+  float t = l > 0.0f ? (px * dx + py * dy) / l : 0.0f;
+  t = t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t;
+  px -= t * dx; py -= t * dy;
+  return px * px + py * py;
+}
+
+// flags the points of `path` to keep in `keep`, `stack` must have room for
+// twice as many indices as there are points. returns false if the contour
+// would be left with less than three points (it is thinner than the
+// tolerance everywhere and can be dropped)
+bool simplify_path(pp_path_t *path, float tolerance2, bool *keep, int *stack) {
+  int n = path->count;
+  if(n < 3) return false;
+  pp_point_t *p = path->points;
+
+  int a = 0;
+  for(int i = 1; i < n; i++) {
+    if(p[i].x < p[a].x || (p[i].x == p[a].x && p[i].y < p[a].y)) a = i;
+  }
+  int b = a;
+  float furthest = 0.0f;
+  for(int i = 0; i < n; i++) {
+    float dx = p[i].x - p[a].x, dy = p[i].y - p[a].y;
+    if(dx * dx + dy * dy > furthest) {furthest = dx * dx + dy * dy; b = i;}
+  }
+  if(furthest <= tolerance2) return false;
+
+  // indices run from a to a + n (a again) so the contour never wraps
+  memset(keep, 0, sizeof(bool) * n);
+  keep[a] = keep[b] = true;
+  if(b < a) b += n;
+  int top = 0, kept = 2;
+  stack[top++] = a; stack[top++] = b;
+  stack[top++] = b; stack[top++] = a + n;
+  while(top) {
+    int j = stack[--top], i = stack[--top];
+    int k = -1;
+    float worst = tolerance2;
+    for(int m = i + 1; m < j; m++) {
+      float d = simplify_distance(p[m % n], p[i % n], p[j % n]);
+      if(d > worst) {worst = d; k = m;}
+    }
+    if(k == -1) continue;
+    keep[k % n] = true;
+    kept++;
+    stack[top++] = i; stack[top++] = k;
+    stack[top++] = k; stack[top++] = j;
+  }
+  return kept >= 3;
+}
+
+// `poly` simplified to within `tolerance` polygon units
+pp_poly_t *simplify_poly(pp_poly_t *poly, float tolerance) {
+  pp_poly_t *result = pp_poly_new();
+  float tolerance2 = tolerance * tolerance;
+
+  int storage = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) storage = _pp_max(storage, path->count);
+  bool *keep = malloc(sizeof(bool) * storage);
+  int *stack = malloc(sizeof(int) * storage * 2);
+
+  pp_path_t *tail = NULL;
+  for(pp_path_t *path = poly->paths; path; path = path->next) {
+    if(!simplify_path(path, tolerance2, keep, stack)) continue;
+
+    pp_path_t *out = malloc(sizeof(pp_path_t));
+    memset(out, 0, sizeof(pp_path_t));
+    out->storage = 8;
+    out->points = malloc(sizeof(pp_point_t) * out->storage);
+    for(int i = 0; i < path->count; i++) {
+      if(keep[i]) pp_path_add_point(out, path->points[i]);
+    }
+
+    if(tail) tail->next = out; else result->paths = out;
+    tail = out;
+  }
+
+  free(keep);
+  free(stack);
+  return result;
+}
+
+// a new polygon made of the points of `poly` needed to follow each of its
+// contours to within `tolerance` pixels once transformed by the current
+// transform (the points themselves are not transformed). contours thinner
+// than the tolerance are dropped. a tolerance of zero drops only duplicate
+// and collinear points. the result is only correct at the scale it was made
+// for so make one per zoom level (or size) rather than one per frame
+pp_poly_t *pp_poly_simplify(pp_poly_t *poly, float tolerance) {
+  float scale = simplify_scale(_pp_transform);
+  return simplify_poly(poly, scale > 0.0f ? tolerance / scale : INFINITY);
+}
+
+int lod_points(pp_poly_t *poly) {
+  int points = 0;
+  for(pp_path_t *path = poly->paths; path; path = path->next) points += path->count;
+  return points;
+}
+
+// up to `levels` levels of detail of `poly`, which must outlive them. the
+// first is accurate to 1/4096th of the polygon's size (enough to draw it up
+// to 1024 pixels across with the default threshold) and each further level
+// allows twice the error of the one before. levels that don't drop any more
+// edges are skipped. the levels are copies made now, after changing the
+// polygon free them and make new ones
+pp_poly_lod_t *pp_poly_lod_new(pp_poly_t *poly, int levels) {
+  pp_poly_lod_t *lod = malloc(sizeof(pp_poly_lod_t));
+  *lod = (pp_poly_lod_t){.poly = poly, .points = lod_points(poly)};
+  if(!poly->paths) return lod;
+
+  pp_rect_t b = pp_poly_bounds(poly);
+  float error = _pp_max(b.w, b.h) / 4096.0f;
+  int edges = lod->points;
+
+  pp_lod_level_t **tail = &lod->levels;
+  for(int i = 0; i < levels && edges; i++, error *= 2.0f) {
+    pp_poly_t *level = simplify_poly(poly, error);
+    int count = lod_points(level);
+    if(count == edges) {
+      pp_poly_free(level);
+      continue;
+    }
+
+    *tail = malloc(sizeof(pp_lod_level_t));
+    **tail = (pp_lod_level_t){.poly = level, .error = error};
+    tail = &(*tail)->next;
+    edges = count;
+  }
+  return lod;
+}
+
+// frees the levels, not the polygon they were made from
+void pp_poly_lod_free(pp_poly_lod_t *lod) {
+  while(lod->levels) {
+    pp_lod_level_t *next = lod->levels->next;
+    pp_poly_free(lod->levels->poly);
+    free(lod->levels);
+    lod->levels = next;
+  }
+  free(lod);
+}
+
+// the coarsest level of detail within the threshold (in pixels) set with
+// pp_lod_threshold() under the current transform, or the original polygon.
+// if points have been added to or removed from the original since the levels
+// were made they are out of date and the original is returned
+pp_poly_t *pp_poly_lod_select(pp_poly_lod_t *lod) {
+  if(!lod->levels || _pp_lod_threshold <= 0.0f) return lod->poly;
+  if(lod_points(lod->poly) != lod->points) {
+    debug("> levels of detail out of date, drawing the original\n");
+    return lod->poly;
+  }
+  float scale = simplify_scale(_pp_transform);
+  pp_poly_t *selected = lod->poly;
+  for(pp_lod_level_t *level = lod->levels; level && level->error * scale <= _pp_lod_threshold; level = level->next) {
+    selected = level->poly;
+  }
+  return selected;
+}
+
+pp_rect_t pp_poly_bounds(pp_poly_t *p) {
   pp_path_t *path = p->paths;
   if(!path) return (pp_rect_t){};  
   pp_rect_t b = pp_path_bounds(path);
@@ -381,32 +1270,373 @@ pp_rect_t pp_polygon_bounds(pp_poly_t *p) {
   return b;
 }
 
-// buffer that each tile is rendered into before callback
-// allocate one extra byte to allow a small optimization in the row renderer
-uint8_t tile_buffer[PP_TILE_BUFFER_SIZE * PP_TILE_BUFFER_SIZE];
+pp_rect_t pp_polygon_bounds(pp_poly_t *p) {
+  return pp_poly_bounds(p);
+}
 
-// polygon node buffer handles at most 16 line intersections per scanline
-// is this enough for cjk/emoji? (requires a 2kB buffer)
-int32_t nodes[PP_TILE_BUFFER_SIZE * 4][PP_MAX_NODES_PER_SCANLINE * 2];
-uint32_t node_counts[PP_TILE_BUFFER_SIZE * 4];
+pp_region_t *pp_region_new() {
+  pp_region_t *region = malloc(sizeof(pp_region_t));
+  region->storage = 8;
+  region->count = 0;
+  region->rects = malloc(sizeof(pp_rect_t) * region->storage);
+  return region;
+}
+
+void pp_region_free(pp_region_t *region) {
+  free(region->rects);
+  free(region);
+}
+
+void pp_region_clear(pp_region_t *region) {
+  region->count = 0;
+}
+
+// add the parts of `r` not already covered by rects `i` onwards. where `r`
+// overlaps a rect it is cut into up to four pieces around it (above, below,
+// left, and right) and each piece is checked against the rects that follow
+void _pp_region_add(pp_region_t *region, pp_rect_t r, int i) {
+  for(; i < region->count; i++) {
+    pp_rect_t *e = &region->rects[i];
+    pp_rect_t o = pp_rect_intersection(&r, e);
+    if(pp_rect_empty(&o)) continue;
+
+    pp_rect_t pieces[4] = {
+      {r.x, r.y, r.w, o.y - r.y},
+      {r.x, o.y + o.h, r.w, r.y + r.h - (o.y + o.h)},
+      {r.x, o.y, o.x - r.x, o.h},
+      {o.x + o.w, o.y, r.x + r.w - (o.x + o.w), o.h}
+    };
+    for(int j = 0; j < 4; j++) {
+      if(!pp_rect_empty(&pieces[j])) _pp_region_add(region, pieces[j], i + 1);
+    }
+    return;
+  }
+
+  if(region->count == region->storage) { // no storage left, double buffer size
+    region->storage *= 2;
+    region->rects = realloc(region->rects, sizeof(pp_rect_t) * region->storage);
+  }
+  region->rects[region->count++] = r;
+}
+
+void pp_region_add(pp_region_t *region, pp_rect_t r) {
+  if(r.w <= 0 || r.h <= 0) return;
+  _pp_region_add(region, r, 0);
+}
+
+// add everything a polygon covers on screen with transform `from` and with
+// transform `to` (either can be NULL for no transform), which is the area
+// that must be redrawn when it moves from one to the other
+void pp_region_add_damage(pp_region_t *region, pp_poly_t *poly, pp_mat3_t *from, pp_mat3_t *to) {
+  pp_rect_t b = pp_poly_bounds(poly);
+  pp_rect_t before = from ? pp_rect_transform(&b, from) : b;
+  pp_rect_t after = to ? pp_rect_transform(&b, to) : b;
+  pp_region_add(region, before);
+  pp_region_add(region, after);
+}
+
+pp_rect_t pp_region_bounds(pp_region_t *region) {
+  if(region->count == 0) return (pp_rect_t){0, 0, 0, 0};
+  pp_rect_t b = region->rects[0];
+  for(int i = 1; i < region->count; i++) b = pp_rect_merge(&b, &region->rects[i]);
+  return b;
+}
+
+bool pp_region_intersects(pp_region_t *region, pp_rect_t *r) {
+  for(int i = 0; i < region->count; i++) {
+    pp_rect_t o = pp_rect_intersection(r, &region->rects[i]);
+    if(!pp_rect_empty(&o)) return true;
+  }
+  return false;
+}
+
+// default buffer that each tile is rendered into before callback, can be
+// replaced at runtime with a caller provided buffer using `pp_tile_buffer()`
+uint8_t tile_buffer[PP_TILE_BUFFER_SIZE * PP_TILE_BUFFER_SIZE];
+uint8_t *_pp_tile_buffer = tile_buffer;
+int32_t  _pp_tile_w = PP_TILE_BUFFER_SIZE, _pp_tile_h = PP_TILE_BUFFER_SIZE;
+
+// polygon nodes (tile relative x coordinates of line intersections) are 
+// stored as 16-bit values in chunks allocated from a pool shared by all of
+// the sub-scanlines of the tile. each sub-scanline has a linked list of chunks
+// with the most recently allocated at its head. a sub-scanline handles at most
+// PP_MAX_NODES_PER_SCANLINE * 2 nodes, is this enough for cjk/emoji?
+#define PP_NODE_CHUNK 4
+_Static_assert(PP_NODE_POOL_SIZE >= (PP_MAX_NODES_PER_SCANLINE * 2) << 3, 
+  "PP_NODE_POOL_SIZE must hold a full row of nodes for every sub-scanline of a pixel row");
+int16_t  node_pool[PP_NODE_POOL_SIZE];
+uint16_t node_links[PP_NODE_POOL_SIZE / PP_NODE_CHUNK];
+uint16_t node_heads[PP_NODE_BUFFER_HEIGHT];
+uint16_t node_counts[PP_NODE_BUFFER_HEIGHT];
+uint32_t _pp_node_chunks = 0;       // chunks allocated from the pool so far
+bool     _pp_node_overflow = false; // set if the pool ran out of chunks
+
+// while a prepared polygon is replayed the nodes of each sub-scanline are read
+// from it (already sorted) rather than from the node pool
+bool           _pp_replaying = false;
+const int16_t *_pp_replay_rows[PP_NODE_BUFFER_HEIGHT];
+
+// range of sub-scanlines that have nodes in the current tile, node counts are
+// reset as rows are rendered so only these rows need to be visited
+int _pp_node_miny = INT_MAX, _pp_node_maxy = -1;
+
+// area of the tile buffer written by the previous tile which must be cleared
+// before the next one is rendered (everything else is already zero). it is
+// in bytes of rows `_pp_tile_dirty_stride` apart, which is narrower than the
+// tile buffer when the tile was packed. a stride of zero means the contents
+// of the whole buffer are unknown
+pp_rect_t _pp_tile_dirty = {0, 0, 0, 0};
+int32_t   _pp_tile_dirty_stride = PP_TILE_BUFFER_SIZE;
+
+// set while the spans of a tile are written a bit per pixel, see span_bits()
+bool _pp_span_bits = false;
+
+// the clip path set with pp_clip_path() is rasterised a cell at a time, the
+// cells form a tile sized grid anchored at the clip path's bounds. tiles
+// rendered while it is set are aligned to the same grid so draws sharing the
+// clip share cells. the coverage of every cell is kept (per antialias level,
+// as the grid is only as tall as a tile at that level) and most cells are
+// entirely inside or outside the clip path, masks of the rest are cached with
+// the least recently used replaced when a new one is needed
+enum {CLIP_UNKNOWN, CLIP_PARTIAL, CLIP_FULL, CLIP_EMPTY};
+typedef struct {
+  pp_rect_t cell;         // empty if unused
+  pp_antialias_t aa;
+  uint32_t used;          // when last used, zero if unused
+} clip_mask_t;
+
+pp_rect_t   _pp_clip_path_bounds;
+uint8_t    *_pp_clip_cells[4] = {NULL};  // coverage of each cell per antialias level
+int32_t     _pp_clip_cols = 0;
+clip_mask_t _pp_clip_masks[PP_CLIP_CACHE_TILES];
+uint8_t    *_pp_clip_mask_data = NULL;   // PP_CLIP_CACHE_TILES tile buffers
+int32_t     _pp_clip_mask_w = 0, _pp_clip_mask_h = 0;
+uint32_t    _pp_clip_mask_clock = 0;
 
 uint8_t _pp_alpha_map_none[2] = {0, 255};
 uint8_t _pp_alpha_map_x4[5] = {0, 63, 127, 190, 255};
 uint8_t _pp_alpha_map_x16[17] = {0, 16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 255};
+uint8_t _pp_alpha_map_x8[9] = {0, 32, 64, 96, 128, 159, 191, 223, 255};
+
+// horizontal sample offset (in 1/8th pixels) for each of the eight X8
+// sub-scanlines - every column is used exactly once (n-rooks) so near vertical
+// and near horizontal edges both resolve to eight coverage levels
+const uint8_t _pp_x8_offsets[8] = {7, 2, 4, 0, 6, 3, 1, 5};
+
+pp_occlusion_t *pp_occlusion_new(int32_t w, int32_t h) {
+  pp_occlusion_t *occlusion = malloc(sizeof(pp_occlusion_t));
+  occlusion->w = w;
+  occlusion->h = h;
+  occlusion->stride = (w + 7) >> 3;
+  occlusion->bits = malloc(occlusion->stride * h);
+  occlusion->spans = malloc(sizeof(int32_t) * 2 * h);
+  pp_occlusion_clear(occlusion);
+  return occlusion;
+}
+
+void pp_occlusion_free(pp_occlusion_t *occlusion) {
+  free(occlusion->bits);
+  free(occlusion->spans);
+  free(occlusion);
+}
+
+void pp_occlusion_clear(pp_occlusion_t *occlusion) {
+  memset(occlusion->bits, 0, occlusion->stride * occlusion->h);
+  for(int32_t y = 0; y < occlusion->h; y++) {
+    occlusion->spans[y * 2] = occlusion->w;
+    occlusion->spans[y * 2 + 1] = -1;
+  }
+}
+
+// hide a rectangle of the mask, for anything already drawn that wasn't
+// rendered with pp_opaque(). rows keep the span of pixels that may be hidden
+// so that tiles over rows with nothing hidden skip the mask, change `bits`
+// through here rather than directly
+void pp_occlusion_hide(pp_occlusion_t *occlusion, pp_rect_t r) {
+  pp_rect_t all = {0, 0, occlusion->w, occlusion->h};
+  r = pp_rect_intersection(&r, &all);
+  if(pp_rect_empty(&r)) return;
+  for(int32_t y = r.y; y < r.y + r.h; y++) {
+    uint8_t *row = occlusion->bits + y * occlusion->stride;
+    for(int32_t x = r.x; x < r.x + r.w; x++) row[x >> 3] |= 0x80 >> (x & 7);
+    int32_t *span = &occlusion->spans[y * 2];
+    span[0] = _pp_min(span[0], r.x);
+    span[1] = _pp_max(span[1], r.x + r.w - 1);
+  }
+}
 
 void pp_clip(int32_t x, int32_t y, int32_t w, int32_t h) {
   _pp_clip = (pp_rect_t){.x = x, .y = y, .w = w, .h = h};
 }
 
+// draw front to back: while set, parts of polygons hidden behind opaque
+// polygons already rendered are skipped. whole tiles and rows of tiles are
+// never rasterised and hidden pixels are removed from the tiles passed to the
+// callback, which must blend *under* what it has already drawn. pass NULL to
+// turn off
+void pp_occlusion(pp_occlusion_t *occlusion) {
+  _pp_occlusion = occlusion;
+}
+
+// whether the polygons rendered from now on hide whatever is drawn after them
+// where they fully cover a pixel, i.e. they will be drawn with an opaque paint
+void pp_opaque(bool opaque) {
+  _pp_opaque = opaque;
+}
+
+// further limit pp_render() and pp_prepare() to the rects of `region`, each
+// tile is rendered once for every rect it overlaps. the region is not copied
+// so changes to it take effect immediately. pass NULL to turn off
+void pp_clip_region(pp_region_t *region) {
+  _pp_clip_region = region;
+}
+
+// clip everything rendered to the inside of the polygon `clip` (even-odd, in
+// screen coordinates - the transform is not applied), as well as to the clip
+// rectangle. the part of `clip` in each tile is rasterised into a mask that
+// scales the coverage of the tile, masks are cached so drawing many polygons
+// inside the same clip costs one mask per tile. call again after changing
+// `clip`, pass NULL to turn off and free the cache. pp_render_canvas() ignores
+// the clip path
+void pp_clip_path(pp_poly_t *clip) {
+  _pp_clip_path = clip && clip->paths ? clip : NULL;
+  for(int aa = 0; aa < 4; aa++) {
+    free(_pp_clip_cells[aa]);
+    _pp_clip_cells[aa] = NULL;
+  }
+  free(_pp_clip_mask_data);
+  _pp_clip_mask_data = NULL;
+  _pp_clip_mask_w = _pp_clip_mask_h = 0;
+  if(_pp_clip_path) _pp_clip_path_bounds = pp_poly_bounds(clip);
+}
+
 void pp_tile_callback(pp_tile_callback_t callback) {
   _pp_tile_callback = callback;
 }
 
+// use `buffer` (at least w * h bytes) for tiles of up to w x h pixels, the
+// tile height is also limited to the node buffer height (PP_NODE_BUFFER_HEIGHT
+// sub-scanlines). tiles are at most INT16_MAX >> 3 (4095) pixels wide so that
+// node x values fit in 16 bits at X8, wider buffers are used with that width
+// as their stride. if everything is drawn at X1 into a 1bpp tile format with
+// no clip path or occlusion mask ((w + 7) >> 3) * h bytes is enough, see
+// pp_tile_format(). passing NULL restores the default PP_TILE_BUFFER_SIZE
+// buffer
+void pp_tile_buffer(uint8_t *buffer, int32_t w, int32_t h) {
+  if(!buffer) {
+    buffer = tile_buffer; w = PP_TILE_BUFFER_SIZE; h = PP_TILE_BUFFER_SIZE;
+  }
+  _pp_tile_buffer = buffer;
+  _pp_tile_w = _pp_min(w, INT16_MAX >> 3);
+  _pp_tile_h = h;
+  _pp_tile_dirty_stride = 0; // unknown contents
+}
+
+// tile callback while autotuning, the tiles aren't wanted
+void _pp_autotune_tile(const pp_tile_t *tile) {
+}
+
+// render the sample scene with each candidate tile shape that fits into 
+// `size` bytes of `buffer` and keep the fastest. `now` must return an
+// increasing time in any unit. the tiles are discarded (the tile callback
+// isn't called and opaque polygons don't add to the occlusion mask) so only
+// rasterisation is timed. returns the chosen tile size, which is left set
+// with `buffer` as the tile buffer as if by pp_tile_buffer()
+pp_rect_t pp_tile_autotune(uint8_t *buffer, int32_t size, pp_poly_t **scene, int count, uint64_t (*now)()) {
+  // candidates are power of two widths plus full width strips when clipped
+  // (unless the clip is empty or already one of the powers of two), all no
+  // wider than pp_tile_buffer() allows
+  int32_t widths[16], candidates = 0, max_w = _pp_min(size, INT16_MAX >> 3);
+  bool strip = _pp_clip.w > 0 && _pp_clip.w <= max_w;
+  for(int32_t w = 8; w <= max_w && candidates < 15; w <<= 1) {
+    widths[candidates++] = w;
+    if(w == _pp_clip.w) strip = false;
+  }
+  if(strip) widths[candidates++] = _pp_clip.w;
+  if(!candidates && max_w > 0) widths[candidates++] = max_w; // tiny buffers
+
+  pp_tile_callback_t callback = _pp_tile_callback;
+  bool opaque = _pp_opaque;
+  _pp_tile_callback = _pp_autotune_tile;
+  _pp_opaque = false;
+
+  pp_rect_t best = {0, 0, _pp_tile_w, _pp_tile_h};
+  uint64_t best_time = UINT64_MAX;
+  for(int i = 0; i < candidates; i++) {
+    int32_t w = widths[i], h = _pp_min(size / w, PP_NODE_BUFFER_HEIGHT);
+    pp_tile_buffer(buffer, w, h);
+
+    // take the quickest of three runs to reduce noise
+    uint64_t time = UINT64_MAX;
+    for(int pass = 0; pass < 3; pass++) {
+      uint64_t start = now();
+      for(int j = 0; j < count; j++) pp_render(scene[j]);
+      uint64_t elapsed = now() - start;
+      if(elapsed < time) time = elapsed;
+    }
+
+    debug("  - autotune %d x %d: %llu\n", w, h, (unsigned long long)time);
+    if(time < best_time) { best_time = time; best = (pp_rect_t){0, 0, w, h}; }
+  }
+
+  _pp_tile_callback = callback;
+  _pp_opaque = opaque;
+  pp_tile_buffer(buffer, best.w, best.h);
+  return best;
+}
+
+// tiles are passed to the callback packed into rows of the buffer's packed
+// width, ((w + 7) >> 3) or ((w + 1) >> 1) bytes apart, and start on a byte
+// boundary (the pixels added on the left have no coverage). at X1, with no
+// clip path or occlusion mask, 1bpp tiles are written a bit per pixel
+// straight from the spans, otherwise the tile is rendered at 8 bits per pixel
+// and then packed
+void pp_tile_format(pp_tile_format_t format) {
+  _pp_tile_format = format;
+}
+
 // maximum tile bounds determined by antialias level
 void pp_antialias(pp_antialias_t antialias) {
   _pp_antialias = antialias;
 }
 
+void pp_antialias_policy(pp_aa_policy_t policy) {
+  _pp_aa_policy = policy;
+}
+
+void pp_lod_threshold(float pixels) {
+  _pp_lod_threshold = pixels;
+}
+
+// pick an antialias level for the polygon from its bounds on screen
+pp_antialias_t pp_antialias_auto(pp_poly_t *polygon, pp_rect_t *pb) {
+  int32_t size = _pp_max(pb->w, pb->h);
+  if(size < _pp_aa_policy.small) return PP_AA_X16;
+
+  // lots of short edges means fine detail that benefits from more samples
+  int edges = 0;
+  for(pp_path_t *path = polygon->paths; path; path = path->next) edges += path->count;
+  if(edges * _pp_aa_policy.detail > (pb->w + pb->h) * 2) return PP_AA_X16;
+
+  if(size < _pp_aa_policy.large) return PP_AA_X4;
+
+  // large fills whose edges are all horizontal or vertical gain little from
+  // antialiasing so check every edge once transformed
+  // (paths without points have no edges to check)
+  for(pp_path_t *path = polygon->paths; path; path = path->next) {
+    if(path->count < 1) continue;
+    pp_point_t last = path->points[path->count - 1];
+    if(_pp_transform) last = pp_point_transform(&last, _pp_transform);
+    for(int i = 0; i < path->count; i++) {
+      pp_point_t next = path->points[i];
+      if(_pp_transform) next = pp_point_transform(&next, _pp_transform);
+      if(fabsf(next.x - last.x) > 0.01f && fabsf(next.y - last.y) > 0.01f) return PP_AA_X4;
+      last = next;
+    }
+  }
+  return PP_AA_NONE;
+}
+
 pp_mat3_t *pp_transform(pp_mat3_t *transform) {
   pp_mat3_t *old = _pp_transform;
   _pp_transform = transform;
@@ -426,8 +1656,56 @@ void debug_tile(const pp_tile_t *tile) {
   debug("-----------------------\n");
 }
 
+// append a node to sub-scanline y, allocating a new chunk when needed
+void add_node(int y, int16_t x) {
+  uint32_t c = node_counts[y];
+  if(c == PP_MAX_NODES_PER_SCANLINE * 2) { // row is full, drop node
+    PP_STAT(_pp_stats.nodes_dropped++);
+    return;
+  }
+
+  if((c & (PP_NODE_CHUNK - 1)) == 0) {
+    if(_pp_node_chunks == PP_NODE_POOL_SIZE / PP_NODE_CHUNK) {
+      _pp_node_overflow = true;
+      return;
+    }
+    node_links[_pp_node_chunks] = node_heads[y];
+    node_heads[y] = _pp_node_chunks++;
+  }
+
+  node_pool[node_heads[y] * PP_NODE_CHUNK + (c & (PP_NODE_CHUNK - 1))] = x;
+  node_counts[y] = c + 1;
+  PP_STAT(_pp_stats.nodes++);
+}
+
+// copy the nodes of sub-scanline y into a contiguous array, returns the count
+int gather_nodes(int y, int16_t *out) {
+  int count = node_counts[y];
+  if(_pp_replaying) {
+    memcpy(out, _pp_replay_rows[y], count * sizeof(int16_t));
+    return count;
+  }
+  uint16_t chunk = node_heads[y];
+  int n = ((count - 1) & (PP_NODE_CHUNK - 1)) + 1; // head chunk may be partial
+  for(int i = 0; i < count; i += n, n = PP_NODE_CHUNK) {
+    memcpy(out + i, &node_pool[chunk * PP_NODE_CHUNK], n * sizeof(int16_t));
+    chunk = node_links[chunk];
+  }
+  return count;
+}
+
+// discard all nodes of the current tile
+void reset_nodes() {
+  for(int y = _pp_node_miny; y <= _pp_node_maxy; y++) node_counts[y] = 0;
+  _pp_node_miny = INT_MAX; _pp_node_maxy = -1;
+  _pp_node_chunks = 0;
+  _pp_node_overflow = false;
+}
+
 void add_line_segment_to_nodes(const pp_point_t start, const pp_point_t end, pp_rect_t *tb) {
-  int32_t sx = start.x, sy = start.y, ex = end.x, ey = end.y;
+  // floor (rather than truncate) so that the result doesn't depend on which
+  // side of the tile origin a point falls
+  int32_t sx = _pp_floor(start.x), sy = _pp_floor(start.y), ex = _pp_floor(end.x), ey = _pp_floor(end.y);
 
   if(ey < sy) {
     // swap endpoints if line "pointing up", we do this because we
@@ -438,23 +1716,31 @@ void add_line_segment_to_nodes(const pp_point_t start, const pp_point_t end, pp_
   }
 
   // early out if line is completely outside the tile, or has no gradient
-  if (ey < 0 || sy >= (int)(tb->h << _pp_antialias) || sy == ey) return;
+  if (ey < 0 || sy >= (int)(tb->h << _pp_aa) || sy == ey) return;
 
   debug("      + line segment from %d, %d to %d, %d\n", sx, sy, ex, ey);
 
   // determine how many in-bounds lines to render
   int y = _pp_max(0, sy);
-  int count = _pp_min((int)(tb->h << _pp_antialias), ey) - y;
+  int count = _pp_min((int)(tb->h << _pp_aa), ey) - y;
+  if(count <= 0) return;
+
+  _pp_node_miny = _pp_min(_pp_node_miny, y);
+  _pp_node_maxy = _pp_max(_pp_node_maxy, y + count - 1);
 
   int x = sx;
   int e = 0;
 
+  // x steps by exactly (ex - sx) / dy per scanline, the node on scanline y is
+  // always the same for a given line whatever its end points so collinear 
+  // edges (e.g. a zero area spike) produce identical nodes and cancel out
   const int xinc = _pp_sign(ex - sx);
-  const int einc = abs(ex - sx) + 1;
+  const int einc = abs(ex - sx);
   const int dy = ey - sy;
 
   // if sy < 0 jump to the start, note this does use a divide
   // but potentially saves many wasted loops below, so is likely worth it.
+  // the jump leaves the same error (0..dy-1) as stepping through would
   if (sy < 0) {
     e = einc * -sy;
     int xjump = e / dy;
@@ -469,13 +1755,13 @@ void add_line_segment_to_nodes(const pp_point_t start, const pp_point_t end, pp_
 //   // loop over scanlines
 //   while(count--) {
 //     // consume accumulated error
-//     while(e > dy) {e -= dy; interp1->add_raw[0] = xinc;}
+//     while(e >= dy) {e -= dy; interp1->add_raw[0] = xinc;}
 
 //     // clamp node x value to tile bounds
 //     const int nx = interp1->peek[0];
 //     debug("      + adding node at %d, %d\n", x, y);
 //     // add node to node list
-//     nodes[y][node_counts[y]++] = nx;
+//     add_node(y, nx);
 
 //     // step to next scanline and accumulate error
 //     y++;
@@ -485,13 +1771,13 @@ void add_line_segment_to_nodes(const pp_point_t start, const pp_point_t end, pp_
   // loop over scanlines
   while(count--) {
     // consume accumulated error
-    while(e > dy) {e -= dy; x += xinc;}
+    while(e >= dy) {e -= dy; x += xinc;}
 
     // clamp node x value to tile bounds
-    int nx = _pp_max(_pp_min(x, (tb->w << _pp_antialias)), 0);        
+    int nx = _pp_max(_pp_min(x, (tb->w << _pp_aa)), 0);        
     //debug("      + adding node at %d, %d\n", x, y);
     // add node to node list
-    nodes[y][node_counts[y]++] = nx;
+    add_node(y, nx);
 
     // step to next scanline and accumulate error
     y++;
@@ -501,7 +1787,9 @@ void add_line_segment_to_nodes(const pp_point_t start, const pp_point_t end, pp_
 }
 
 void build_nodes(pp_path_t *path, pp_rect_t *tb) {
-  PP_COORD_TYPE aa_scale = (PP_COORD_TYPE)(1 << _pp_antialias);
+  if(path->count < 1) return; // no points, no edges
+
+  PP_COORD_TYPE aa_scale = (PP_COORD_TYPE)(1 << _pp_aa);
 
   pp_point_t tile_origin = (pp_point_t){tb->x * aa_scale, tb->y * aa_scale};
 
@@ -522,90 +1810,634 @@ void build_nodes(pp_path_t *path, pp_rect_t *tb) {
 }
 
 int compare_nodes(const void* a, const void* b) {
-  return *((int*)a) - *((int*)b);
+  return *((int16_t*)a) - *((int16_t*)b);
 }
 
-pp_rect_t render_nodes(pp_rect_t *tb) {
-  pp_rect_t rb = {PP_TILE_BUFFER_SIZE << _pp_antialias, PP_TILE_BUFFER_SIZE << _pp_antialias, 0, 0}; // render bounds
-  int maxx = 0, minx = PP_TILE_BUFFER_SIZE << _pp_antialias;
-  debug("  + render tile %d, %d - %d, %d\n", tb->x, tb->y, tb->w, tb->h);
+// sort the nodes of a sub-scanline into ascending x order
+void sort_nodes(int16_t *nodes, int count) {
+  qsort(nodes, count, sizeof(int16_t), compare_nodes);
+}
 
-  for(int y = 0; y < ((int)PP_TILE_BUFFER_SIZE << _pp_antialias); y++) {
+// add the coverage of the span from sx to ex (in sub-sample units) on `count` 
+// identical sub-scanlines, starting at sub-scanline `y`, to the row data
+void fill_span(uint8_t *row_data, int sx, int ex, int y, int count) {
+  if(_pp_aa == PP_AA_X8) {
+    // pixels fully inside the span are covered on every sub-scanline
+    int ia = (sx + 7) >> 3, ib = ex >> 3;
+    for(int px = ia; px < ib; px++) row_data[px] += count;
+    ia = _pp_min(ia, ib); ib = _pp_max(ia, ib);
+
+    // otherwise there is only one sample per pixel on each sub-scanline so 
+    // count the pixels whose sample position falls inside the span
+    while(count--) {
+      int o = _pp_x8_offsets[y++ & 0b111];
+      int px = (sx - o + 7) >> 3, pe = (ex - o + 7) >> 3;
+      while(px < _pp_min(pe, ia)) row_data[px++]++;
+      px = _pp_max(px, ib);
+      while(px < pe) row_data[px++]++;
+    }
+    return;
+  }
+
+  // work at pixel rate: partial coverage at either end of the span and full
+  // coverage (every sample of every sub-scanline) for the pixels in between
+  int mask = (1 << _pp_aa) - 1;
+  int px = sx >> _pp_aa, pe = ex >> _pp_aa;
+  if(px == pe) { row_data[px] += (ex - sx) * count; return; }
+  if(sx & mask) { row_data[px] += ((mask + 1) - (sx & mask)) * count; px++; }
+  uint8_t full = (mask + 1) * count;
+  while(px < pe) row_data[px++] += full;
+  if(ex & mask) row_data[pe] += (ex & mask) * count;
+}
 
-    // debug("    : row %d node count %d\n", y, node_counts[y]);
+// set the bits of pixels sx to ex of a 1bpp row. at X1 a span either covers
+// a pixel or it doesn't and the spans of a row never overlap
+void fill_span_bits(uint8_t *row_data, int sx, int ex) {
+  int b0 = sx >> 3, b1 = (ex - 1) >> 3;
+  uint8_t m0 = 0xff >> (sx & 7), m1 = 0xff << (7 - ((ex - 1) & 7));
+  if(b0 == b1) { row_data[b0] |= m0 & m1; return; }
+  row_data[b0] |= m0;
+  memset(row_data + b0 + 1, 0xff, b1 - b0 - 1);
+  row_data[b1] |= m1;
+}
 
-    if(node_counts[y] == 0) continue; // no nodes on this raster line
+// convert the sample counts in area rb of the tile buffer into alpha values
+void resolve_alpha(const pp_rect_t *rb) {
+  uint8_t *p_alpha_map = _pp_alpha_map_none;
+  if(_pp_aa == 1) p_alpha_map = _pp_alpha_map_x4;
+  if(_pp_aa == 2) p_alpha_map = _pp_alpha_map_x16;
+  if(_pp_aa == 3) p_alpha_map = _pp_alpha_map_x8;
+  PP_STAT(_pp_stats.pixels_resolved += rb->w * rb->h);
+  #if PP_SCALE_TO_ALPHA == 1
+    for(int y = rb->y; y < rb->y + rb->h; y++) {
+      unsigned char* row_data = &_pp_tile_buffer[y * _pp_tile_w + rb->x];
+      for(int x = rb->x; x < rb->x + rb->w; x++) {      
+        *row_data = p_alpha_map[*row_data];
+        row_data++;
+      }
+    }
+  #else
+    (void)p_alpha_map;
+  #endif
+}
 
-    qsort(&nodes[y][0], node_counts[y], sizeof(int), compare_nodes);
+// bytes per row of the tile buffer once packed into the tile format
+int32_t packed_stride() {
+  switch(_pp_tile_format) {
+    case PP_TILE_4BPP: return (_pp_tile_w + 1) >> 1;
+    case PP_TILE_1BPP:
+    case PP_TILE_1BPP_DITHER: return (_pp_tile_w + 7) >> 3;
+    default: return _pp_tile_w;
+  }
+}
 
-    unsigned char* row_data = &tile_buffer[(y >> _pp_antialias) * PP_TILE_BUFFER_SIZE];
+// at X1 a pixel is either covered or not so 1bpp tiles can be written a bit
+// per pixel straight from the spans, unless a clip path or occlusion mask
+// needs the coverage a byte per pixel first
+bool span_bits() {
+  return _pp_aa == PP_AA_NONE && !_pp_clip_path && !_pp_occlusion &&
+    (_pp_tile_format == PP_TILE_1BPP || _pp_tile_format == PP_TILE_1BPP_DITHER);
+}
 
-    for(uint32_t i = 0; i < node_counts[y]; i += 2) {
-      int sx = nodes[y][i + 0];
-      int ex = nodes[y][i + 1];
+// pack the alpha values in area rb of the tile buffer into the tile format.
+// rb must start on a byte boundary of the packed row. each row moves down to
+// packed_stride() bytes after the last, which never overtakes the alpha values
+// still to be read. (x, y) is the position of rb on screen and anchors the
+// dither pattern so that it is continuous across tiles
+void pack_alpha(const pp_rect_t *rb, int32_t x, int32_t y) {
+  static const uint8_t bayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+  int32_t stride = packed_stride();
+  for(int py = 0; py < rb->h; py++) {
+    const uint8_t *row = &_pp_tile_buffer[(rb->y + py) * _pp_tile_w + rb->x];
+    if(_pp_tile_format == PP_TILE_4BPP) {
+      uint8_t *out = &_pp_tile_buffer[(rb->y + py) * stride + (rb->x >> 1)];
+      for(int px = 0; px < rb->w; px += 2) {
+        uint8_t lo = px + 1 < rb->w ? row[px + 1] >> 4 : 0;
+        out[px >> 1] = (row[px] & 0xf0) | lo;
+      }
+    } else {
+      uint8_t *out = &_pp_tile_buffer[(rb->y + py) * stride + (rb->x >> 3)];
+      // thresholds from 8 to 248 so that 0 and 255 are never dithered
+      const uint8_t *t = bayer[(y + py) & 3];
+      bool dither = _pp_tile_format == PP_TILE_1BPP_DITHER;
+      for(int px = 0; px < rb->w; px += 8) {
+        uint8_t bits = 0;
+        int n = _pp_min(8, rb->w - px);
+        for(int i = 0; i < n; i++) {
+          int threshold = dither ? t[(x + px + i) & 3] * 16 + 8 : 128;
+          bits |= (row[px + i] >= threshold) << (7 - i);
+        }
+        out[px >> 3] = bits;
+      }
+    }
+  }
+}
 
-      if(sx == ex) { // empty span, nothing to do
-        continue;
+pp_rect_t render_nodes(pp_rect_t *tb) {
+  pp_rect_t rb = {_pp_tile_w << _pp_aa, _pp_tile_h << _pp_aa, 0, 0}; // render bounds
+  int maxx = 0, minx = _pp_tile_w << _pp_aa;
+  debug("  + render tile %d, %d - %d, %d\n", tb->x, tb->y, tb->w, tb->h);
+  PP_STAT_DECL(uint64_t t = PP_CLOCK());
+  PP_TRACE_BEGIN(trace_span);
+
+  int aa_rows = 1 << _pp_aa; // sub-scanlines per pixel row
+  int16_t row_nodes[PP_MAX_NODES_PER_SCANLINE * 2], next_nodes[PP_MAX_NODES_PER_SCANLINE * 2];
+
+  // only visit the pixel rows that have nodes
+  int py_end = _pp_node_maxy < 0 ? 0 : (_pp_node_maxy >> _pp_aa) + 1;
+  for(int py = _pp_node_miny >> _pp_aa; py < py_end; py++) {
+    unsigned char* row_data = &_pp_tile_buffer[py * (_pp_span_bits ? (_pp_tile_w + 7) >> 3 : _pp_tile_w)];
+
+    int y = py << _pp_aa, ye = y + aa_rows;
+    while(y < ye) {
+      // debug("    : row %d node count %d\n", y, node_counts[y]);
+
+      if(node_counts[y] == 0) { y++; continue; } // no nodes on this raster line
+
+      int node_count = gather_nodes(y, row_nodes);
+      PP_STAT(_pp_stats.max_nodes_per_row = _pp_max(_pp_stats.max_nodes_per_row, node_count));
+      PP_STAT(_pp_stats.rows++);
+
+      // if the following sub-scanlines of this pixel row have exactly the same
+      // nodes (no edge changes x) then they are rasterised together in one 
+      // pass, typically only rows touched by a sloped edge are supersampled
+      int count = 1;
+      while(y + count < ye && node_counts[y + count] == node_count &&
+            gather_nodes(y + count, next_nodes) &&
+            memcmp(next_nodes, row_nodes, node_count * sizeof(int16_t)) == 0) {
+        count++;
       }
 
-      // update render bounds
-      rb.x = _pp_min(rb.x, sx);
-      rb.y = _pp_min(rb.y, y);      
-      minx = _pp_min(_pp_min(sx, ex), minx);
-      maxx = _pp_max(_pp_max(sx, ex), maxx);
-      rb.h = y - rb.y + 1;
+      if(!_pp_replaying) sort_nodes(row_nodes, node_count);
+
+      for(int i = 0; i < node_count; i += 2) {
+        int sx = row_nodes[i + 0];
+        int ex = row_nodes[i + 1];
+
+        if(sx == ex) { // empty span, nothing to do
+          continue;
+        }
 
-      //debug(" - render span at %d from %d to %d\n", y, sx, ex);
+        // update render bounds
+        rb.x = _pp_min(rb.x, sx);
+        rb.y = _pp_min(rb.y, y);      
+        minx = _pp_min(_pp_min(sx, ex), minx);
+        maxx = _pp_max(_pp_max(sx, ex), maxx);
+        rb.h = y + count - rb.y;
 
-      // rasterise the span into the tile buffer
-      do {
-        row_data[sx >> _pp_antialias]++;
-      } while(++sx < ex);
+        //debug(" - render span at %d from %d to %d\n", y, sx, ex);
+
+        // rasterise the span into the tile buffer
+        if(_pp_span_bits) {
+          fill_span_bits(row_data, sx, ex);
+        } else {
+          fill_span(row_data, sx, ex, y, count);
+        }
+      }
+
+      y += count;
     }
   }
 
+  // ready for the next tile
+  reset_nodes();
+
   rb.w = maxx - minx;
 
   // shifting the width and height effectively "floors" the result which can
   // mean we lose a pixel off the right or bottom edge of the tile. by adding
-  // either 1 (at x4) or 3 (at x16) we change that to a "ceil" instead ensuring
-  // the full tile bounds are returned
-  if(_pp_antialias) {
-    int maxx = rb.x + rb.w + (_pp_antialias | 0b1);
-    int maxy = rb.y + rb.h + (_pp_antialias | 0b1);
-
-    rb.x >>= _pp_antialias;
-    rb.y >>= _pp_antialias;
-    rb.w = (maxx >> _pp_antialias) - rb.x;
-    rb.h = (maxy >> _pp_antialias) - rb.y;
+  // 1 (at x4), 3 (at x16), or 7 (at x8) we change that to a "ceil" instead 
+  // ensuring the full tile bounds are returned
+  if(_pp_aa) {
+    int maxx = rb.x + rb.w + ((1 << _pp_aa) - 1);
+    int maxy = rb.y + rb.h + ((1 << _pp_aa) - 1);
+
+    rb.x >>= _pp_aa;
+    rb.y >>= _pp_aa;
+    rb.w = (maxx >> _pp_aa) - rb.x;
+    rb.h = (maxy >> _pp_aa) - rb.y;
   }
   
-  uint8_t *p_alpha_map = _pp_alpha_map_none;
-  if(_pp_antialias == 1) p_alpha_map = _pp_alpha_map_x4;
-  if(_pp_antialias == 2) p_alpha_map = _pp_alpha_map_x16;
-  #if PP_SCALE_TO_ALPHA == 1
-    for(int y = rb.y; y < rb.y + rb.h; y++) {
-      unsigned char* row_data = &tile_buffer[y * PP_TILE_BUFFER_SIZE + rb.x];
-      for(int x = rb.x; x < rb.x + rb.w; x++) {      
-        *row_data = p_alpha_map[*row_data];
-        row_data++;
-      }
-    }
-  #endif
+  PP_STAT(_pp_stats.time_span += PP_CLOCK() - t; t = PP_CLOCK());
+  PP_TRACE_END("span", trace_span, *tb);
+  PP_TRACE_BEGIN(trace_resolve);
+  if(!_pp_span_bits) resolve_alpha(&rb);
+  PP_STAT(_pp_stats.time_resolve += PP_CLOCK() - t);
+  PP_TRACE_END("resolve", trace_resolve, *tb);
 
   debug("    : rendered tile bounds %d, %d (%d x %d)\n", rb.x, rb.y, rb.w, rb.h);
 
   return rb;
 }
 
-void pp_render(pp_poly_t *polygon) {
+void emit_tile(pp_rect_t tb);
 
-  debug("> draw polygon with %u contours\n", pp_poly_path_count(polygon));
+// coverage value of a fully covered pixel
+uint8_t full_coverage() {
+#if PP_SCALE_TO_ALPHA == 1
+  return 255;
+#else
+  return _pp_aa == PP_AA_X8 ? 8 : 1 << (_pp_aa * 2);
+#endif
+}
 
-  if(!polygon->paths) return;
+// tiles can be no taller than the node buffer allows at the current antialias
+// level (e.g. by default tiles are only half as tall at X8)
+int32_t tile_height() {
+  return _pp_min(_pp_tile_h, PP_NODE_BUFFER_HEIGHT >> _pp_aa);
+}
+
+// where tiles covering from `v` onwards start. while a clip path is set they
+// are aligned to the grid of its masks (anchored at `origin`), otherwise they
+// start at `v`
+int32_t tile_start(int32_t v, int32_t origin, int32_t size) {
+  if(!_pp_clip_path) return v;
+  int32_t o = (v - origin) % size;
+  return v - (o < 0 ? o + size : o);
+}
+
+// rasterise the clip path in `cell` into `mask` (with the tile buffer's
+// stride). if the node pool runs out the cell is split in half and retried
+void rasterise_clip(pp_rect_t cell, uint8_t *mask) {
+  pp_mat3_t *transform = pp_transform(NULL);
+  for(pp_path_t *path = _pp_clip_path->paths; path; path = path->next) {
+    build_nodes(path, &cell);
+  }
+  pp_transform(transform);
+
+  if(_pp_node_overflow && cell.h > 1) {
+    reset_nodes();
+    pp_rect_t top = cell, bottom = cell;
+    top.h = cell.h / 2;
+    bottom.y += top.h; bottom.h -= top.h;
+    rasterise_clip(top, mask);
+    rasterise_clip(bottom, mask + top.h * _pp_tile_w);
+    return;
+  }
+
+  uint8_t *buffer = _pp_tile_buffer;
+  _pp_tile_buffer = mask;
+  render_nodes(&cell);
+  _pp_tile_buffer = buffer;
+}
+
+// the clip path's coverage of `cell`, CLIP_FULL, CLIP_EMPTY, or CLIP_PARTIAL
+// with its mask in `data` (taken from the cache or rasterised into the least
+// recently used entry)
+int clip_mask(pp_rect_t cell, uint8_t **data) {
+  pp_rect_t *b = &_pp_clip_path_bounds;
+  int32_t size = _pp_tile_w * _pp_tile_h, tile_h = tile_height();
+  if(_pp_clip_mask_w != _pp_tile_w || _pp_clip_mask_h != _pp_tile_h) {
+    // first use or the tile buffer changed shape, start again
+    for(int aa = 0; aa < 4; aa++) {
+      free(_pp_clip_cells[aa]);
+      _pp_clip_cells[aa] = NULL;
+    }
+    _pp_clip_mask_data = realloc(_pp_clip_mask_data, PP_CLIP_CACHE_TILES * size);
+    _pp_clip_mask_w = _pp_tile_w; _pp_clip_mask_h = _pp_tile_h;
+    _pp_clip_cols = (b->w + _pp_tile_w - 1) / _pp_tile_w;
+    memset(_pp_clip_masks, 0, sizeof(_pp_clip_masks));
+  }
+  if(!_pp_clip_cells[_pp_aa]) {
+    _pp_clip_cells[_pp_aa] = calloc(_pp_clip_cols * ((b->h + tile_h - 1) / tile_h), 1);
+  }
+
+  uint8_t *coverage = &_pp_clip_cells[_pp_aa][
+    ((cell.y - b->y) / tile_h) * _pp_clip_cols + (cell.x - b->x) / _pp_tile_w];
+  if(*coverage == CLIP_FULL || *coverage == CLIP_EMPTY) {
+    PP_STAT(_pp_stats.clip_mask_hits++);
+    return *coverage;
+  }
+
+  int lru = 0;
+  for(int i = 0; i < PP_CLIP_CACHE_TILES; i++) {
+    clip_mask_t *m = &_pp_clip_masks[i];
+    if(m->aa == _pp_aa && m->cell.x == cell.x && m->cell.y == cell.y && m->used) {
+      PP_STAT(_pp_stats.clip_mask_hits++);
+      m->used = ++_pp_clip_mask_clock;
+      *data = _pp_clip_mask_data + i * size;
+      return CLIP_PARTIAL;
+    }
+    if(m->used < _pp_clip_masks[lru].used) lru = i;
+  }
+
+  PP_STAT(_pp_stats.clip_masks++);
+  *data = _pp_clip_mask_data + lru * size;
+  memset(*data, 0, _pp_tile_w * cell.h);
+
+  // the nodes of a prepared polygon being replayed have already been rendered
+  bool replaying = _pp_replaying;
+  _pp_replaying = false;
+  rasterise_clip(cell, *data);
+  _pp_replaying = replaying;
+
+  uint8_t full = full_coverage();
+  bool any = false, all = true;
+  for(int32_t y = 0; y < cell.h; y++) {
+    const uint8_t *row = *data + y * _pp_tile_w;
+    for(int32_t x = 0; x < cell.w; x++) {
+      any |= row[x] != 0;
+      all &= row[x] == full;
+    }
+  }
+  *coverage = all ? CLIP_FULL : any ? CLIP_PARTIAL : CLIP_EMPTY;
+
+  // only partial masks are worth keeping, the entry's old mask is gone either way
+  _pp_clip_masks[lru] = (clip_mask_t){0};
+  if(*coverage == CLIP_PARTIAL) {
+    _pp_clip_masks[lru] = (clip_mask_t){.cell = cell, .aa = _pp_aa, .used = ++_pp_clip_mask_clock};
+  }
+  return *coverage;
+}
+
+// shrink area rb of the tile buffer to the rows and columns that still have
+// coverage, empty if none do
+pp_rect_t trim_alpha(const pp_rect_t *rb) {
+  int32_t x0 = rb->w, x1 = 0, y0 = rb->h, y1 = 0;
+  for(int32_t py = 0; py < rb->h; py++) {
+    const uint8_t *row = &_pp_tile_buffer[(rb->y + py) * _pp_tile_w + rb->x];
+    int32_t l = 0, r = rb->w;
+    while(l < r && !row[l]) l++;
+    if(l == r) continue;
+    while(!row[r - 1]) r--;
+    x0 = _pp_min(x0, l); x1 = _pp_max(x1, r);
+    y0 = _pp_min(y0, py); y1 = py + 1;
+  }
+  if(y0 >= y1) return (pp_rect_t){0, 0, 0, 0};
+  return (pp_rect_t){rb->x + x0, rb->y + y0, x1 - x0, y1 - y0};
+}
+
+// scale the coverage in area rb of the tile buffer (at x, y on screen) by the
+// coverage of the clip path, returns the area that still has coverage
+pp_rect_t clip_alpha(const pp_rect_t *rb, int32_t x, int32_t y) {
+  pp_rect_t *b = &_pp_clip_path_bounds;
+  pp_rect_t sb = {x, y, rb->w, rb->h};
+  pp_rect_t in = pp_rect_intersection(&sb, b);
+
+  // clear anything outside of the clip path's bounds
+  for(int32_t py = 0; py < rb->h; py++) {
+    uint8_t *row = &_pp_tile_buffer[(rb->y + py) * _pp_tile_w + rb->x];
+    if(pp_rect_empty(&in) || y + py < in.y || y + py >= in.y + in.h) {
+      memset(row, 0, rb->w);
+      continue;
+    }
+    memset(row, 0, in.x - x);
+    memset(row + in.x + in.w - x, 0, x + rb->w - (in.x + in.w));
+  }
+  if(pp_rect_empty(&in)) return (pp_rect_t){0, 0, 0, 0};
+
+  // only trim when some coverage was cleared or scaled
+  bool cleared = in.x != x || in.y != y || in.w != rb->w || in.h != rb->h;
+  uint8_t full = full_coverage();
+  int32_t tile_h = tile_height();
+  for(int32_t cy = tile_start(in.y, b->y, tile_h); cy < in.y + in.h; cy += tile_h) {
+    for(int32_t cx = tile_start(in.x, b->x, _pp_tile_w); cx < in.x + in.w; cx += _pp_tile_w) {
+      pp_rect_t cell = {cx, cy, _pp_tile_w, tile_h};
+      cell = pp_rect_intersection(&cell, b);
+      pp_rect_t part = pp_rect_intersection(&cell, &in);
+      if(pp_rect_empty(&part)) continue;
+
+      uint8_t *mask;
+      int coverage = clip_mask(cell, &mask);
+      if(coverage == CLIP_FULL) continue;
+      cleared = true;
+
+      for(int32_t py = part.y; py < part.y + part.h; py++) {
+        uint8_t *p = &_pp_tile_buffer[(rb->y + py - y) * _pp_tile_w + rb->x + part.x - x];
+        if(coverage == CLIP_EMPTY) {
+          memset(p, 0, part.w);
+          continue;
+        }
+        const uint8_t *q = &mask[(py - cell.y) * _pp_tile_w + part.x - cell.x];
+        for(int32_t px = 0; px < part.w; px++) {
+          if(q[px] != full) p[px] = (p[px] * q[px] + (full >> 1)) / full;
+        }
+      }
+    }
+  }
+  return cleared ? trim_alpha(rb) : *rb;
+}
+
+// true if pixels x to x + w of row y are all hidden
+bool occluded_row(int32_t y, int32_t x, int32_t w) {
+  pp_occlusion_t *o = _pp_occlusion;
+  if(y < 0 || y >= o->h || x < 0 || x + w > o->w || w <= 0) return false;
+  if(x < o->spans[y * 2] || x + w - 1 > o->spans[y * 2 + 1]) return false;
+  const uint8_t *row = o->bits + y * o->stride;
+  int32_t b0 = x >> 3, b1 = (x + w - 1) >> 3;
+  uint8_t m0 = 0xff >> (x & 7), m1 = 0xff << (7 - ((x + w - 1) & 7));
+  if(b0 == b1) return (row[b0] & m0 & m1) == (m0 & m1);
+  if((row[b0] & m0) != m0 || (row[b1] & m1) != m1) return false;
+  for(int32_t b = b0 + 1; b < b1; b++) {
+    if(row[b] != 0xff) return false;
+  }
+  return true;
+}
+
+// drop the hidden rows from the top and bottom of the tile, false if every
+// row is hidden
+bool occlusion_trim(pp_rect_t *tb) {
+  while(tb->h > 0 && occluded_row(tb->y, tb->x, tb->w)) { tb->y++; tb->h--; }
+  while(tb->h > 0 && occluded_row(tb->y + tb->h - 1, tb->x, tb->w)) tb->h--;
+  return tb->h > 0;
+}
+
+// clear the coverage of hidden pixels in area rb of the tile buffer (at x, y
+// on screen) and, for opaque polygons, hide the pixels they fully cover.
+// returns the area that still has coverage
+pp_rect_t occlude_alpha(const pp_rect_t *rb, int32_t x, int32_t y) {
+  pp_occlusion_t *o = _pp_occlusion;
+  uint8_t full = full_coverage();
+  uint64_t full8 = full * 0x0101010101010101ull;
+  bool cleared = false;
+  int32_t x0 = _pp_max(x, 0), x1 = _pp_min(x + rb->w, o->w);
+  int32_t y0 = _pp_max(y, 0), y1 = _pp_min(y + rb->h, o->h);
+  for(int32_t sy = y0; sy < y1; sy++) {
+    uint8_t *row = o->bits + sy * o->stride;
+    uint8_t *p = &_pp_tile_buffer[(rb->y + sy - y) * _pp_tile_w + rb->x - x];
+    int32_t *span = &o->spans[sy * 2];
+    // nothing on this row of the tile is hidden, there is only work to do if
+    // the polygon can hide pixels
+    bool clear = span[0] >= x1 || span[1] < x0;
+    if(clear && !_pp_opaque) continue;
+    int32_t hide0 = x1, hide1 = -1;
+    // a byte of the mask (eight pixels) at a time
+    for(int32_t sx = x0; sx < x1;) {
+      uint8_t bits = clear ? 0 : row[sx >> 3];
+      int32_t end = _pp_min((sx | 7) + 1, x1);
+      cleared |= bits != 0;
+      if(bits == 0xff) {
+        memset(p + sx, 0, end - sx);
+      } else if(bits || _pp_opaque) {
+        uint8_t hide = 0;
+        uint64_t eight = 1;
+        if(!bits && end - sx == 8) memcpy(&eight, p + sx, 8);
+        if(eight == full8 || eight == 0) {
+          // a whole byte of the mask with nothing hidden and all or none of
+          // its eight pixels fully covered
+          hide = eight ? 0xff : 0;
+        } else {
+          for(int32_t px = sx; px < end; px++) {
+            uint8_t bit = 0x80 >> (px & 7);
+            if(bits & bit) {
+              p[px] = 0;
+            } else if(_pp_opaque && p[px] == full) {
+              hide |= bit;
+            }
+          }
+        }
+        if(hide) {
+          row[sx >> 3] |= hide;
+          hide0 = _pp_min(hide0, sx);
+          hide1 = end - 1;
+        }
+      }
+      sx = end;
+    }
+    span[0] = _pp_min(span[0], hide0);
+    span[1] = _pp_max(span[1], hide1);
+  }
+  return cleared ? trim_alpha(rb) : *rb;
+}
+
+// rasterise the polygon into the tile buffer and pass the result to the tile
+// callback. if the node pool runs out the tile is split in half and retried
+void render_tile(pp_poly_t *polygon, pp_rect_t tb) {
+  if(_pp_occlusion && !occlusion_trim(&tb)) {
+    PP_STAT(_pp_stats.tiles_occluded++);
+    return;
+  }
+
+  PP_STAT(_pp_stats.tiles_visited++);
+  PP_STAT_DECL(uint64_t t = PP_CLOCK());
+  PP_TRACE_BEGIN(trace_build);
+
+  // build the nodes for each pp_path_t
+  for(pp_path_t *path = polygon->paths; path; path = path->next) {
+    debug("    : build nodes for path (%d points)\n", path->count);
+    build_nodes(path, &tb);
+  }
+
+  PP_STAT(_pp_stats.time_build += PP_CLOCK() - t);
+  PP_TRACE_END("build", trace_build, tb);
+
+  if(_pp_node_overflow && tb.h > 1) {
+    debug("    : node pool exhausted, splitting tile\n");
+    PP_STAT(_pp_stats.tiles_split++);
+    reset_nodes();
+    pp_rect_t top = tb, bottom = tb;
+    top.h = tb.h / 2;
+    bottom.y += top.h; bottom.h -= top.h;
+    render_tile(polygon, top);
+    render_tile(polygon, bottom);
+    return;
+  }
+
+  emit_tile(tb);
+}
+
+// render the nodes built for `tb` into the tile buffer and pass the result to
+// the tile callback
+void emit_tile(pp_rect_t tb) {
+  bool bits = span_bits();
+  int32_t stride = packed_stride();
+
+  // clear the part of the tile buffer dirtied by the previous tile, the
+  // node counts were already reset when they were rendered
+  if(_pp_tile_dirty_stride) {
+    for(int32_t dy = _pp_tile_dirty.y; dy < _pp_tile_dirty.y + _pp_tile_dirty.h; dy++) {
+      memset(_pp_tile_buffer + dy * _pp_tile_dirty_stride + _pp_tile_dirty.x, 0, _pp_tile_dirty.w);
+    }
+  } else {
+    memset(_pp_tile_buffer, 0, (bits ? stride : _pp_tile_w) * _pp_tile_h);
+  }
+  _pp_tile_dirty = (pp_rect_t){0, 0, 0, 0};
+  _pp_tile_dirty_stride = _pp_tile_w;
+
+  debug("    : render the tile\n");
+  // render the tile
+
+  // clipping and occlusion can clear coverage, the tile is trimmed to what
+  // is left (and skipped if nothing is)
+  _pp_span_bits = bits;
+  pp_rect_t rb = render_nodes(&tb);
+  _pp_span_bits = false;
+  if(_pp_clip_path && !pp_rect_empty(&rb)) rb = clip_alpha(&rb, tb.x + rb.x, tb.y + rb.y);
+  if(_pp_occlusion && !pp_rect_empty(&rb)) rb = occlude_alpha(&rb, tb.x + rb.x, tb.y + rb.y);
+  if(bits && !pp_rect_empty(&rb)) {
+    _pp_tile_dirty = (pp_rect_t){rb.x >> 3, rb.y, ((rb.x + rb.w + 7) >> 3) - (rb.x >> 3), rb.h};
+    _pp_tile_dirty_stride = stride;
+  } else if(!bits) {
+    _pp_tile_dirty = rb;
+  }
+  tb.x += rb.x; tb.y += rb.y; tb.w = rb.w; tb.h = rb.h;
+
+  if(pp_rect_empty(&tb)) {
+    debug("    : empty after rendering, skipping\n");
+    PP_STAT(_pp_stats.tiles_empty++);
+    return;
+  }
+
+  int32_t offset = rb.x;
+  if(_pp_tile_format != PP_TILE_8BPP) {
+    // start on a byte boundary of the packed row
+    int32_t align = _pp_tile_format == PP_TILE_4BPP ? 1 : 7;
+    tb.x -= rb.x & align; tb.w += rb.x & align;
+    rb.x &= ~align; rb.w = tb.w;
+    offset = rb.x >> (_pp_tile_format == PP_TILE_4BPP ? 1 : 3);
+
+    if(!bits) {
+      PP_STAT_DECL(uint64_t tp = PP_CLOCK());
+      PP_TRACE_BEGIN(trace_pack);
+      pack_alpha(&rb, tb.x, tb.y);
+      PP_STAT(_pp_stats.time_resolve += PP_CLOCK() - tp);
+      PP_TRACE_END("pack", trace_pack, tb);
+
+      // the packed rows were moved up into the rows above the tile
+      int32_t top = rb.y * stride / _pp_tile_w;
+      _pp_tile_dirty = (pp_rect_t){0, top, _pp_tile_w, rb.y + rb.h - top};
+    }
+  } else {
+    stride = _pp_tile_w;
+  }
+
+  pp_tile_t tile = {        
+    .x = tb.x, .y = tb.y, .w = tb.w, .h = tb.h,
+    .stride = stride,
+    .data = _pp_tile_buffer + offset + stride * rb.y,
+    .antialias = _pp_aa,
+    .format = _pp_tile_format
+  };
+
+  PP_STAT(_pp_stats.tiles_rendered++);
+  PP_STAT_DECL(uint64_t t = PP_CLOCK());
+  PP_TRACE_BEGIN(trace_callback);
+  _pp_tile_callback(&tile);
+  PP_STAT(_pp_stats.time_callback += PP_CLOCK() - t);
+  PP_TRACE_END("callback", trace_callback, tb);
+}
+
+// number of areas the clip splits rendering into, one per rect of the clip
+// region if there is one
+int clip_areas() {
+  return _pp_clip_region ? _pp_clip_region->count : 1;
+}
+
+// the part of the polygon bounds `pb` inside the clip rectangle, clip path
+// bounds, and clip region rect `area`
+pp_rect_t clip_area(pp_rect_t *pb, int area) {
+  pp_rect_t cb = pp_rect_intersection(pb, &_pp_clip);
+  if(_pp_clip_path) cb = pp_rect_intersection(&cb, &_pp_clip_path_bounds);
+  if(_pp_clip_region) cb = pp_rect_intersection(&cb, &_pp_clip_region->rects[area]);
+  return cb;
+}
+
+// transformed bounds of the polygon, also picks its antialias level
+pp_rect_t render_bounds(pp_poly_t *polygon) {
+  PP_STAT_DECL(uint64_t t = PP_CLOCK());
 
   // determine extreme bounds
-  pp_rect_t pb = pp_polygon_bounds(polygon);
+  pp_rect_t pb = pp_poly_bounds(polygon);
 
   if(_pp_transform) {
     pb = pp_rect_transform(&pb, _pp_transform);
@@ -614,6 +2446,28 @@ void pp_render(pp_poly_t *polygon) {
   debug("  - polygon bounds %d, %d (%d x %d)\n", pb.x, pb.y, pb.w, pb.h);
   debug("  - clip %d, %d (%d x %d)\n", _pp_clip.x, _pp_clip.y, _pp_clip.w, _pp_clip.h);
 
+  _pp_aa = _pp_antialias == PP_AA_AUTO ? pp_antialias_auto(polygon, &pb) : _pp_antialias;
+  debug("  - antialias level %d\n", _pp_aa);
+
+  PP_STAT(
+    _pp_stats.polygons++;
+    for(pp_path_t *path = polygon->paths; path; path = path->next) {
+      _pp_stats.paths++; _pp_stats.edges += path->count;
+    }
+    _pp_stats.time_bounds += PP_CLOCK() - t;
+  );
+
+  return pb;
+}
+
+void pp_render(pp_poly_t *polygon) {
+  debug("> draw polygon with %u contours\n", pp_poly_path_count(polygon));
+
+  if(!polygon->paths) return;
+
+  PP_TRACE_BEGIN(trace_render);
+  pp_rect_t pb = render_bounds(polygon);
+
 #ifdef USE_RP2040_INTERP
   interp_hw_save_t interp1_save;
   interp_save(interp1, &interp1_save);
@@ -625,51 +2479,370 @@ void pp_render(pp_poly_t *polygon) {
   interp1->base[0] = 0;
 #endif
 
-  // iterate over tiles
+  int32_t tile_h = tile_height();
+
+  // iterate over tiles, starting from the clipped bounds so that when the
+  // clip rectangle is smaller than a tile (e.g. one screen tile of a
+  // compositor) the polygon is rasterised once rather than in up to four parts
   debug("  - processing tiles\n");
-  for(int32_t y = pb.y; y < pb.y + pb.h; y += PP_TILE_BUFFER_SIZE) {
-    for(int32_t x = pb.x; x < pb.x + pb.w; x += PP_TILE_BUFFER_SIZE) {
-      pp_rect_t tb = (pp_rect_t){.x = x, .y = y, .w = PP_TILE_BUFFER_SIZE, .h = PP_TILE_BUFFER_SIZE};
-      tb = pp_rect_intersection(&tb, &_pp_clip);
-      debug("    : %d, %d (%d x %d)\n", tb.x, tb.y, tb.w, tb.h);
+  for(int area = 0; area < clip_areas(); area++) {
+    pp_rect_t cb = clip_area(&pb, area);
+    pp_rect_t *b = &_pp_clip_path_bounds;
+    for(int32_t y = tile_start(cb.y, b->y, tile_h); y < cb.y + cb.h; y += tile_h) {
+      for(int32_t x = tile_start(cb.x, b->x, _pp_tile_w); x < cb.x + cb.w; x += _pp_tile_w) {
+        pp_rect_t tb = (pp_rect_t){.x = x, .y = y, .w = _pp_tile_w, .h = tile_h};
+        tb = pp_rect_intersection(&tb, &cb);
+        debug("    : %d, %d (%d x %d)\n", tb.x, tb.y, tb.w, tb.h);
+
+        // if no intersection then skip tile
+        if(pp_rect_empty(&tb)) { debug("    : empty when clipped, skipping\n"); continue; }
+
+        PP_TRACE_BEGIN(trace_tile);
+        PP_STAT_DECL(pp_stats_t before = _pp_stats);
+        PP_STAT_DECL(uint64_t t0 = PP_CLOCK());
+        render_tile(polygon, tb);
+        PP_STAT(
+          if(_pp_heatmap) {
+            uint64_t time = PP_CLOCK() - t0 - (_pp_stats.time_callback - before.time_callback);
+            _pp_heatmap_add(_pp_heatmap, tb, _pp_stats.nodes - before.nodes, _pp_stats.rows - before.rows, time);
+          }
+        );
+        PP_TRACE_END("tile", trace_tile, tb);
+      }
+    }
+  }
+
+#ifdef USE_RP2040_INTERP
+  interp_restore(interp1, &interp1_save);
+#endif
+
+  PP_TRACE_END("pp_render", trace_render, pb);
+}
+
+// draw the coarsest level of detail within the threshold, see
+// pp_poly_lod_select(). for pp_render_canvas() and pp_prepare() pass them
+// the selected level
+void pp_render_lod(pp_poly_lod_t *lod) {
+  pp_render(pp_poly_lod_select(lod));
+}
+
+// rasterise the part of the polygon in `tb` straight into the canvas, which
+// is standing in for the tile buffer, then hide any occluded pixels. the rows
+// of `tb` are cleared first and if the node pool runs out the band is split in
+// half and retried
+void render_band(pp_poly_t *polygon, pp_rect_t tb, uint8_t *canvas) {
+  PP_STAT(_pp_stats.tiles_visited++);
+  PP_STAT_DECL(uint64_t t = PP_CLOCK());
+  PP_TRACE_BEGIN(trace_build);
+
+  for(pp_path_t *path = polygon->paths; path; path = path->next) {
+    build_nodes(path, &tb);
+  }
+
+  PP_STAT(_pp_stats.time_build += PP_CLOCK() - t);
+  PP_TRACE_END("build", trace_build, tb);
+
+  if(_pp_node_overflow && tb.h > 1) {
+    PP_STAT(_pp_stats.tiles_split++);
+    reset_nodes();
+    pp_rect_t top = tb, bottom = tb;
+    top.h = tb.h / 2;
+    bottom.y += top.h; bottom.h -= top.h;
+    render_band(polygon, top, canvas);
+    render_band(polygon, bottom, canvas);
+    return;
+  }
 
-      // if no intersection then skip tile
-      if(pp_rect_empty(&tb)) { debug("    : empty when clipped, skipping\n"); continue; }
+  _pp_tile_buffer = canvas + tb.x + tb.y * _pp_tile_w;
+  for(int32_t y = 0; y < tb.h; y++) {
+    memset(_pp_tile_buffer + y * _pp_tile_w, 0, tb.w);
+  }
 
-      // clear existing tile data and nodes
-      memset(node_counts, 0, sizeof(node_counts));
-      memset(tile_buffer, 0, PP_TILE_BUFFER_SIZE * PP_TILE_BUFFER_SIZE);
+  pp_rect_t rb = render_nodes(&tb);
+  if(rb.h == 0) {
+    PP_STAT(_pp_stats.tiles_empty++);
+    return;
+  }
+  if(_pp_occlusion) occlude_alpha(&rb, tb.x + rb.x, tb.y + rb.y);
+  PP_STAT(_pp_stats.tiles_rendered++);
+}
 
-      // build the nodes for each pp_path_t
-      pp_path_t *path = polygon->paths;
-      if(!path) return;
-      do {
-        debug("    : build nodes for path (%d points)\n", path->count);
-        build_nodes(path, &tb);
-        path = path->next;
-      } while(path);
+// render the polygon's coverage into `canvas` (w x h alpha values) without
+// tiling. every pixel inside the returned rectangle (the polygon's bounds
+// clipped to the clip rectangle and canvas) is overwritten, the rest of the
+// canvas is left alone. while a clip region is set only the pixels of that
+// rectangle inside the region are written, those in the gaps between its
+// rects are left alone too. the occlusion mask hides (and, when opaque, is
+// updated with) pixels as in pp_render(). a clip path, the tile format, the
+// tile buffer, and the tile callback are not used
+pp_rect_t pp_render_canvas(pp_poly_t *polygon, uint8_t *canvas, int32_t w, int32_t h) {
+  pp_rect_t cb = {0, 0, w, h};
+
+  debug("> draw polygon with %u contours to canvas\n", pp_poly_path_count(polygon));
+
+  if(!polygon->paths) return (pp_rect_t){0, 0, 0, 0};
+
+  pp_rect_t pb = render_bounds(polygon);
+  pb = pp_rect_intersection(&pb, &_pp_clip);
+  pb = pp_rect_intersection(&pb, &cb);
+  if(pp_rect_empty(&pb)) return (pp_rect_t){0, 0, 0, 0};
+
+  PP_TRACE_BEGIN(trace_render);
+
+  uint8_t *buffer = _pp_tile_buffer;
+  int32_t tile_w = _pp_tile_w;
+  _pp_tile_w = w;
+
+  // bands are as tall as the node buffer allows and, as node x values must 
+  // fit in 16 bits, at most 4095 pixels wide
+  int32_t band_h = PP_NODE_BUFFER_HEIGHT >> _pp_aa, band_w = INT16_MAX >> 3;
+  for(int area = 0; area < clip_areas(); area++) {
+    pp_rect_t ab = _pp_clip_region ? pp_rect_intersection(&pb, &_pp_clip_region->rects[area]) : pb;
+    if(pp_rect_empty(&ab)) continue;
+    for(int32_t y = ab.y; y < ab.y + ab.h; y += band_h) {
+      for(int32_t x = ab.x; x < ab.x + ab.w; x += band_w) {
+        pp_rect_t tb = {x, y, _pp_min(band_w, ab.x + ab.w - x), _pp_min(band_h, ab.y + ab.h - y)};
+        render_band(polygon, tb, canvas);
+      }
+    }
+  }
 
-      debug("    : render the tile\n");
-      // render the tile
+  _pp_tile_buffer = buffer;
+  _pp_tile_w = tile_w;
 
-      pp_rect_t rb = render_nodes(&tb);
-      tb.x += rb.x; tb.y += rb.y; tb.w = rb.w; tb.h = rb.h;
+  PP_TRACE_END("pp_render_canvas", trace_render, pb);
+  return pb;
+}
 
-      if(pp_rect_empty(&tb)) { debug("    : empty after rendering, skipping\n"); continue; }
+// 16-bit values in the header of each prepared tile
+#define PP_PREPARED_TILE 8
 
-      pp_tile_t tile = {        
-        .x = tb.x, .y = tb.y, .w = tb.w, .h = tb.h,
-        .stride = PP_TILE_BUFFER_SIZE,
-        .data = tile_buffer + rb.x + (PP_TILE_BUFFER_SIZE * rb.y)
-      };
+// a tile coordinate stored in prepared data as its low then high 16 bits
+int32_t prepared_int32(const int16_t *in) {
+  return (int32_t)((uint16_t)in[0] | ((uint32_t)(uint16_t)in[1] << 16));
+}
+
+// append the sorted nodes of the polygon in `tb` to the prepared data. if the
+// node pool runs out the tile is split in half and retried
+void prepare_tile(pp_poly_t *polygon, pp_rect_t tb, pp_prepared_t *prepared) {
+  PP_STAT(_pp_stats.tiles_visited++);
+  PP_STAT_DECL(uint64_t t = PP_CLOCK());
+
+  for(pp_path_t *path = polygon->paths; path; path = path->next) {
+    build_nodes(path, &tb);
+  }
 
-      _pp_tile_callback(&tile);
+  PP_STAT(_pp_stats.time_build += PP_CLOCK() - t);
+
+  if(_pp_node_overflow && tb.h > 1) {
+    PP_STAT(_pp_stats.tiles_split++);
+    reset_nodes();
+    pp_rect_t top = tb, bottom = tb;
+    top.h = tb.h / 2;
+    bottom.y += top.h; bottom.h -= top.h;
+    prepare_tile(polygon, top, prepared);
+    prepare_tile(polygon, bottom, prepared);
+    return;
+  }
+
+  if(_pp_node_maxy < 0) { // no edges cross this tile, nothing to reset
+    PP_STAT(_pp_stats.tiles_empty++);
+    return;
+  }
+
+  // room for the tile header, a count per sub-scanline, and every node
+  int rows = _pp_node_maxy - _pp_node_miny + 1;
+  uint32_t needed = prepared->count + PP_PREPARED_TILE + rows + _pp_node_chunks * PP_NODE_CHUNK;
+  if(needed > prepared->storage) {
+    while(needed > prepared->storage) prepared->storage *= 2;
+    prepared->data = realloc(prepared->data, sizeof(int16_t) * prepared->storage);
+  }
+
+  int16_t *out = prepared->data + prepared->count;
+  // the clip is unbounded by default so tiles can be anywhere, their
+  // position is stored in full
+  *out++ = tb.x; *out++ = tb.x >> 16; *out++ = tb.y; *out++ = tb.y >> 16;
+  *out++ = tb.w; *out++ = tb.h;
+  *out++ = _pp_node_miny; *out++ = rows;
+  for(int y = _pp_node_miny; y <= _pp_node_maxy; y++) {
+    int count = gather_nodes(y, out + 1);
+    sort_nodes(out + 1, count);
+    *out = count;
+    out += count + 1;
+  }
+  prepared->count = out - prepared->data;
+  prepared->tile_w = _pp_max(prepared->tile_w, tb.w);
+  prepared->tile_h = _pp_max(prepared->tile_h, tb.h);
+
+  reset_nodes();
+}
+
+// build the nodes of every tile the polygon covers, using the current
+// transform, clip, antialias level, and tile buffer size, so that it can be
+// rendered again and again with pp_render_prepared() without repeating that
+// work. the result doesn't refer to the polygon which can be freed
+pp_prepared_t *pp_prepare(pp_poly_t *polygon) {
+  pp_prepared_t *prepared = malloc(sizeof(pp_prepared_t));
+  *prepared = (pp_prepared_t){.storage = 256};
+  prepared->data = malloc(sizeof(int16_t) * prepared->storage);
+
+  if(!polygon->paths) return prepared;
+
+  pp_rect_t pb = render_bounds(polygon);
+  prepared->antialias = _pp_aa;
+
+  // the same tiles as pp_render()
+  int32_t tile_h = tile_height();
+  for(int area = 0; area < clip_areas(); area++) {
+    pp_rect_t cb = clip_area(&pb, area);
+    pp_rect_t *b = &_pp_clip_path_bounds;
+    for(int32_t y = tile_start(cb.y, b->y, tile_h); y < cb.y + cb.h; y += tile_h) {
+      for(int32_t x = tile_start(cb.x, b->x, _pp_tile_w); x < cb.x + cb.w; x += _pp_tile_w) {
+        pp_rect_t tb = (pp_rect_t){.x = x, .y = y, .w = _pp_tile_w, .h = tile_h};
+        tb = pp_rect_intersection(&tb, &cb);
+        if(pp_rect_empty(&tb)) continue;
+        prepare_tile(polygon, tb, prepared);
+      }
+    }
+    if(!pp_rect_empty(&cb)) {
+      prepared->bounds = pp_rect_empty(&prepared->bounds) ? cb : pp_rect_merge(&prepared->bounds, &cb);
     }
   }
 
-#ifdef USE_RP2040_INTERP
-  interp_restore(interp1, &interp1_save);
-#endif
+  return prepared;
+}
+
+void pp_prepared_free(pp_prepared_t *prepared) {
+  free(prepared->data);
+  free(prepared);
+}
+
+// render a polygon prepared by pp_prepare() with the current tile callback and
+// tile format. nothing is drawn if the tile buffer is now smaller than the
+// tiles it was prepared with
+void pp_render_prepared(const pp_prepared_t *prepared) {
+  if(prepared->tile_w > _pp_tile_w || prepared->tile_h > _pp_tile_h) {
+    debug("> prepared tiles larger than tile buffer, skipping\n");
+    return;
+  }
+
+  PP_TRACE_BEGIN(trace_render);
+  PP_STAT(_pp_stats.polygons++);
+  _pp_aa = prepared->antialias;
+
+  _pp_replaying = true;
+  const int16_t *in = prepared->data, *end = prepared->data + prepared->count;
+  while(in < end) {
+    pp_rect_t tb = {prepared_int32(in), prepared_int32(in + 2), in[4], in[5]};
+    int miny = in[6], rows = in[7];
+    in += PP_PREPARED_TILE;
+    for(int y = miny; y < miny + rows; y++) {
+      node_counts[y] = *in;
+      _pp_replay_rows[y] = in + 1;
+      in += *in + 1;
+    }
+    _pp_node_miny = miny;
+    _pp_node_maxy = miny + rows - 1;
+
+    PP_TRACE_BEGIN(trace_tile);
+    PP_STAT(_pp_stats.tiles_visited++);
+    emit_tile(tb);
+    PP_TRACE_END("tile", trace_tile, tb);
+  }
+  _pp_replaying = false;
+
+  PP_TRACE_END("pp_render_prepared", trace_render, prepared->bounds);
+}
+
+// prepared polygons are saved as little endian 32-bit values: "PPN2", bounds
+// x, y, w, h, antialias level, tile w, h, and the value count, then the 16-bit
+// values themselves
+#define PP_PREPARED_MAGIC 0x324e5050
+#define PP_PREPARED_HEADER 9
+
+// write the prepared polygon into `buffer` (if not NULL), returns its size in
+// bytes
+size_t pp_prepared_save(const pp_prepared_t *prepared, uint8_t *buffer) {
+  size_t size = PP_PREPARED_HEADER * 4 + prepared->count * 2;
+  if(!buffer) return size;
+
+  uint32_t header[PP_PREPARED_HEADER] = {
+    PP_PREPARED_MAGIC,
+    prepared->bounds.x, prepared->bounds.y, prepared->bounds.w, prepared->bounds.h,
+    prepared->antialias, prepared->tile_w, prepared->tile_h, prepared->count
+  };
+  for(int i = 0; i < PP_PREPARED_HEADER; i++) {
+    for(int b = 0; b < 4; b++) *buffer++ = header[i] >> (b * 8);
+  }
+  for(uint32_t i = 0; i < prepared->count; i++) {
+    *buffer++ = prepared->data[i];
+    *buffer++ = (uint16_t)prepared->data[i] >> 8;
+  }
+  return size;
+}
+
+// walk the tiles of a loaded prepared polygon checking every count and node
+// against the tile it is in
+bool prepared_valid(const pp_prepared_t *prepared) {
+  int aa = prepared->antialias;
+  const int16_t *in = prepared->data, *end = in + prepared->count;
+  while(in < end) {
+    if(end - in < PP_PREPARED_TILE) return false;
+    int w = in[4], h = in[5], miny = in[6], rows = in[7];
+    if(w < 0 || h < 0 || w > prepared->tile_w || h > prepared->tile_h ||
+       miny < 0 || rows < 1 || miny + rows > (h << aa)) return false;
+    // tiles must not reach past the largest coordinate
+    if(prepared_int32(in) > INT32_MAX - w || prepared_int32(in + 2) > INT32_MAX - h) return false;
+    in += PP_PREPARED_TILE;
+    while(rows--) {
+      if(in == end) return false;
+      int n = *in++;
+      if(n < 0 || (n & 1) || n > PP_MAX_NODES_PER_SCANLINE * 2 || end - in < n) return false;
+      // nodes must be in order or spans could overlap and overflow the
+      // sample counts
+      for(int i = 0; i < n; i++) {
+        if(in[i] < (i ? in[i - 1] : 0) || in[i] > (w << aa)) return false;
+      }
+      in += n;
+    }
+  }
+  return true;
+}
+
+// read a prepared polygon written by pp_prepared_save(), the data is checked
+// so that replaying it can't write outside of the tile buffer. returns NULL if
+// it is invalid
+pp_prepared_t *pp_prepared_load(const uint8_t *buffer, size_t size) {
+  if(size < PP_PREPARED_HEADER * 4) return NULL;
+
+  uint32_t header[PP_PREPARED_HEADER];
+  for(int i = 0; i < PP_PREPARED_HEADER; i++, buffer += 4) {
+    header[i] = buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+  }
+  uint32_t count = header[8];
+  int32_t aa = header[5], tile_w = header[6], tile_h = header[7];
+  if(header[0] != PP_PREPARED_MAGIC || size != PP_PREPARED_HEADER * 4 + (size_t)count * 2 ||
+     aa < PP_AA_NONE || aa > PP_AA_X8 || tile_w < 0 || tile_h < 0 ||
+     tile_w > (INT16_MAX >> 3) || tile_h > (PP_NODE_BUFFER_HEIGHT >> aa)) {
+    return NULL;
+  }
+
+  pp_prepared_t *prepared = malloc(sizeof(pp_prepared_t));
+  *prepared = (pp_prepared_t){
+    .bounds = {header[1], header[2], header[3], header[4]},
+    .antialias = aa, .tile_w = tile_w, .tile_h = tile_h,
+    .count = count, .storage = count ? count : 1
+  };
+  prepared->data = malloc(sizeof(int16_t) * prepared->storage);
+  for(uint32_t i = 0; i < count; i++, buffer += 2) {
+    prepared->data[i] = buffer[0] | (buffer[1] << 8);
+  }
+
+  if(!prepared_valid(prepared)) {
+    pp_prepared_free(prepared);
+    return NULL;
+  }
+  return prepared;
 }
 
 #endif // PP_IMPLEMENTATION